@@ -0,0 +1,143 @@
+/* Channel benchmark (Linux)
+   Measures messaging between interpreters running in different threads
+   through the channels of BIPLAN_Channel.h: throughput with one and two
+   producers, round trip latency of a ping-pong and the same exchange of
+   two interpreters taking turns in one thread. Host threads passing the
+   same amount of messages are measured for comparison. Compile from the
+   repository root with:
+
+   g++ -O2 -Isrc examples/LINUX/channel-benchmark/channel-benchmark.cpp \
+     -o channel-benchmark -lpthread */
+
+#define BP_CHANNELS 3
+
+#include "BCC.h"
+#include "BIPLAN.h"
+
+#define MESSAGES 1000000
+#define ROUND_TRIPS 100000
+#define CELLS 256
+
+BCC compiler;
+BIPLAN_Interpreter interpreters[3];
+bp_channel_cell_t cells[3][CELLS];
+bp_channel_t channels[3];
+
+void error_callback(char *position, const char *string) {
+  printf("Error: %s\n", string);
+};
+
+/* Producers send from 1 to n and 0 when done, the consumer sends the sum
+   of the values received and their amount on channel 2 to the host. */
+char producer[] =
+  "for $i = 1 to $n send 0, $i next send 0, 0 stop";
+char consumer[] =
+  "$s = 0 $c = 0 $d = 0 while $d < $p \n\
+    recv 0, $v \n\
+    if $v $s = $s + $v $c = $c + 1 else $d = $d + 1 end \n\
+  next send 2, $s send 2, $c stop";
+char ping[] = "for $i = 1 to $n send 0, $i recv 1, $v next stop";
+char pong[] = "for $i = 1 to $n recv 0, $v send 1, $v next stop";
+
+char programs[4][256];
+
+double elapsed(uint32_t t) { return (micros() - t) / 1000.0; };
+
+void execute(BIPLAN_Interpreter *interpreter) {
+  while(!interpreter->finished()) {
+    interpreter->run();
+    if(interpreter->waiting) std::this_thread::yield();
+  }
+};
+
+/* Compiles source in a slot, $n and $p are set by the host ------------- */
+void prepare(uint8_t slot, const char *source, uint32_t n, uint32_t p) {
+  snprintf(programs[slot], sizeof(programs[slot]), "$n = %u $p = %u %s",
+    n, p, source);
+  compiler.run(programs[slot]);
+  if(compiler.fail) exit(1);
+  BIPLAN_Interpreter &i = interpreters[slot];
+  i.initialize(programs[slot], error_callback, stdout, 0, 0);
+  for(uint8_t c = 0; c < 3; c++) i.attach_channel(c, &channels[c]);
+};
+
+void reset_channels(bool mpsc) {
+  bp_channel_init(channels[0], cells[0], CELLS, mpsc);
+  bp_channel_init(channels[1], cells[1], CELLS);
+  bp_channel_init(channels[2], cells[2], CELLS);
+};
+
+/* Throughput of producers interpreters (slots 1, 2) to slot 0 ---------- */
+void throughput(const char *name, uint8_t producers) {
+  reset_channels(producers > 1);
+  prepare(0, consumer, 0, producers);
+  for(uint8_t p = 1; p <= producers; p++)
+    prepare(p, producer, MESSAGES / producers, 0);
+  uint32_t t = micros();
+  std::thread threads[3];
+  for(uint8_t i = 0; i <= producers; i++)
+    threads[i] = std::thread(execute, &interpreters[i]);
+  for(uint8_t i = 0; i <= producers; i++) threads[i].join();
+  double ms = elapsed(t);
+  BP_VAR_TYPE sum = 0, count = 0;
+  bp_channel_recv(channels[2], sum);
+  bp_channel_recv(channels[2], count);
+  printf(
+    "%-12s %10.0f  %8.1f  %s\n", name, count / (ms / 1000.0),
+    (ms * 1e6) / count, (count == MESSAGES) ? "ok" : "LOST"
+  );
+};
+
+/* Host threads passing the same amount of messages --------------------- */
+void host_producer(uint32_t n) {
+  for(uint32_t i = 1; i <= n; i++)
+    while(!bp_channel_send(channels[0], i)) std::this_thread::yield();
+};
+
+void host_throughput() {
+  reset_channels(false);
+  uint32_t t = micros(), count = 0;
+  std::thread producer(host_producer, MESSAGES);
+  BP_VAR_TYPE v;
+  while(count < MESSAGES)
+    if(bp_channel_recv(channels[0], v)) count++;
+    else std::this_thread::yield();
+  producer.join();
+  double ms = elapsed(t);
+  printf(
+    "%-12s %10.0f  %8.1f  ok\n", "host spsc", count / (ms / 1000.0),
+    (ms * 1e6) / count
+  );
+};
+
+/* Round trips of ping (slot 0) and pong (slot 1) ----------------------- */
+void latency(const char *name, bool threads) {
+  reset_channels(false);
+  prepare(0, ping, ROUND_TRIPS, 0);
+  prepare(1, pong, ROUND_TRIPS, 0);
+  uint32_t t = micros();
+  if(threads) {
+    std::thread a(execute, &interpreters[0]), b(execute, &interpreters[1]);
+    a.join();
+    b.join();
+  } else // Time-sliced, each one runs until it waits or ends
+    while(!interpreters[0].finished() || !interpreters[1].finished())
+      for(uint8_t i = 0; i < 2; i++)
+        while(!interpreters[i].finished() && interpreters[i].run())
+          if(interpreters[i].waiting) break;
+  double ms = elapsed(t);
+  printf("%-12s %10.2fus\n", name, (ms * 1000.0) / ROUND_TRIPS);
+};
+
+int main() {
+  compiler.error_callback = error_callback;
+  printf("BIPLAN channel benchmark, %u messages\n\n", MESSAGES);
+  printf("path              msg/s    ns/msg\n");
+  throughput("spsc", 1);
+  throughput("mpsc", 2);
+  host_throughput();
+  printf("\nping-pong    round trip\n");
+  latency("threads", true);
+  latency("one thread", false);
+  return 0;
+};
@@ -0,0 +1,77 @@
+/* Square root and random benchmark (Linux)
+   Compares bp_isqrt, bp_fsqrt and bp_random (see BIPLAN_Number.h) with
+   sqrt on doubles and with rand scaled through doubles (bp_linux_random),
+   then runs programs calling sqrt and random. Compile from the repository
+   root with:
+
+   g++ -O2 -Isrc examples/LINUX/math-benchmark/math-benchmark.cpp \
+     -o math-benchmark */
+
+#include "BCC.h"
+#include "BIPLAN.h"
+
+#define CALLS 10000000
+
+BCC compiler;
+BIPLAN_Interpreter interpreter;
+volatile BP_VAR_TYPE sink;
+
+void error_callback(char *position, const char *string) {
+  printf("Error: %s\n", string);
+};
+
+struct test_t {
+  const char *name;
+  const char *program;
+};
+
+test_t tests[] = {
+  {
+    "sqrt",
+    "$s = 0 for $i = 0 to 200000 $s = $s + sqrt $i * 7919 next print $s stop"
+  }, {
+    "random",
+    "$s = 0 for $i = 0 to 200000 $s = $s + random 1000 next print $s stop"
+  }
+};
+
+double elapsed(uint32_t t) { return (micros() - t) / 1000.0; };
+
+int main() {
+  printf("BIPLAN math benchmark, %u calls\n\n", CALLS);
+  printf("function              time\n");
+  uint32_t t = micros();
+  for(uint32_t i = 0; i < CALLS; i++)
+    sink = (BP_VAR_TYPE)sqrt((double)(i * 7919UL));
+  printf("sqrt (double)   %8.2fms\n", elapsed(t));
+  t = micros();
+  for(uint32_t i = 0; i < CALLS; i++) sink = bp_isqrt(i * 7919UL);
+  printf("bp_isqrt        %8.2fms\n", elapsed(t));
+  t = micros();
+  for(uint32_t i = 0; i < CALLS; i++) sink = bp_fsqrt(i * 7919UL);
+  printf("bp_fsqrt        %8.2fms\n", elapsed(t));
+  t = micros();
+  for(uint32_t i = 0; i < CALLS; i++) sink = bp_linux_random(1000);
+  printf("rand (double)   %8.2fms\n", elapsed(t));
+  uint32_t state = BP_RANDOM_SEED;
+  t = micros();
+  for(uint32_t i = 0; i < CALLS; i++) sink = bp_random(state, 0, 1000);
+  printf("bp_random       %8.2fms\n\n", elapsed(t));
+
+  printf("program  output and time\n");
+  for(uint8_t i = 0; i < (sizeof(tests) / sizeof(test_t)); i++) {
+    static char program[256];
+    strcpy(program, tests[i].program);
+    compiler.error_callback = error_callback;
+    compiler.run(program);
+    if(compiler.fail) return 1;
+    interpreter.initialize(program, error_callback, stdout, 0, 0);
+    interpreter.random_seed(1);
+    t = micros();
+    printf("%-8s ", tests[i].name);
+    fflush(stdout);
+    while(!interpreter.finished()) interpreter.run();
+    printf(" %.2fms\n", elapsed(t));
+  }
+  return 0;
+};
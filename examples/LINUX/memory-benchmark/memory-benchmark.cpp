@@ -0,0 +1,99 @@
+/* Bulk memory builtins benchmark (Linux)
+   Compares memfill, memcopy, memsum, memminmax, memscale and memdot with
+   the equivalent interpreted loops over 16 bits samples and reports the
+   time per element. Compile from the repository root with:
+
+   g++ -O2 -Isrc examples/LINUX/memory-benchmark/memory-benchmark.cpp \
+     -o memory-benchmark
+
+   Add -mavx2 to use the AVX2 kernels or -DBP_MEM_SCALAR to compare with
+   the portable scalar kernels. */
+
+#define BP_MEM_SIZE 4096
+
+#include "BCC.h"
+#include "BIPLAN.h"
+
+#define SAMPLES 2048
+
+BCC compiler;
+BIPLAN_Interpreter interpreter;
+
+void error_callback(char *position, const char *string) {
+  printf("Error: %s\n", string);
+};
+
+struct test_t {
+  const char *name;
+  uint32_t elements;
+  const char *loop;
+  const char *builtin;
+};
+
+test_t tests[] = {
+  {
+    "fill", 2048,
+    "for $i = 0 to 2047 @16[$i] = 7 next",
+    "memfill @16[0], 2048, 7"
+  }, {
+    "copy", 1024,
+    "for $i = 0 to 1023 @16[$i + 1024] = @16[$i] next",
+    "memcopy @16[1024], @16[0], 1024"
+  }, {
+    "sum", 2048,
+    "$s = 0 for $i = 0 to 2047 $s = $s + @s16[$i] next",
+    "$s = memsum @s16[0], 2048"
+  }, {
+    "minmax", 2048,
+    "$lo = @s16[0] $hi = $lo for $i = 0 to 2047 $v = @s16[$i] \
+      if $v < $lo $lo = $v end if $v > $hi $hi = $v end next",
+    "memminmax @s16[0], 2048, $lo, $hi"
+  }, {
+    "scale", 2048,
+    "for $i = 0 to 2047 @s16[$i] = (@s16[$i] * 3) >> 2 next",
+    "memscale @s16[0], 2048, 3, 2"
+  }, {
+    "dot", 1024,
+    "$s = 0 for $i = 0 to 1023 $s = $s + (@s16[$i] * @s16[$i + 1024]) next",
+    "$s = memdot @s16[0], @s16[1024], 1024"
+  }
+};
+
+/* Run a statement repeated times, returns nanoseconds per element */
+double run(const char *statement, uint32_t times, uint32_t elements) {
+  static char program[1024];
+  snprintf(
+    program, sizeof(program),
+    "for $r = 1 to %u \n %s \n next \n stop \n", times, statement
+  );
+  compiler.error_callback = error_callback;
+  compiler.run(program);
+  if(compiler.fail) return 0;
+  interpreter.initialize(program, error_callback, stdout, 0, 0);
+  for(uint32_t i = 0; i < BP_MEM_SIZE; i++) interpreter.memory[i] = rand();
+  uint32_t time = micros();
+  while(!interpreter.finished()) interpreter.run();
+  time = micros() - time;
+  return (time * 1000.0) / ((double)times * elements);
+};
+
+int main() {
+  #if defined(BP_MEM_SIMD) && defined(__AVX2__)
+    printf("BIPLAN bulk memory benchmark, AVX2 kernels\n");
+  #elif defined(BP_MEM_SIMD)
+    printf("BIPLAN bulk memory benchmark, SSE2 kernels\n");
+  #else
+    printf("BIPLAN bulk memory benchmark, scalar kernels\n");
+  #endif
+  printf("%u samples of 16 bits, time per element\n\n", SAMPLES);
+  printf("operation    loop      builtin    speedup\n");
+  for(uint8_t i = 0; i < (sizeof(tests) / sizeof(test_t)); i++) {
+    double l = run(tests[i].loop, 20, tests[i].elements);
+    double b = run(tests[i].builtin, 20000, tests[i].elements);
+    printf(
+      "%-8s %7.2fns  %8.3fns  %8.0fx\n",
+      tests[i].name, l, b, (b > 0) ? l / b : 0
+    );
+  }
+  return 0;
+};
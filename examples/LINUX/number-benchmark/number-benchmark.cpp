@@ -0,0 +1,93 @@
+/* Number conversion benchmark (Linux)
+   Compares bp_atol and bp_ltoa (see BIPLAN_Number.h) with the host atol
+   and snprintf, then runs programs dominated by numeric literals, number
+   and printed numbers writing to /dev/null. Compile from the repository
+   root with:
+
+   g++ -O2 -Isrc examples/LINUX/number-benchmark/number-benchmark.cpp \
+     -o number-benchmark */
+
+#include "BCC.h"
+#include "BIPLAN.h"
+
+#define CONVERSIONS 2000000
+
+BCC compiler;
+BIPLAN_Interpreter interpreter;
+volatile BP_VAR_TYPE sink;
+
+void error_callback(char *position, const char *string) {
+  printf("Error: %s\n", string);
+};
+
+struct test_t {
+  const char *name;
+  const char *program;
+};
+
+test_t tests[] = {
+  {
+    "literals",
+    "$s = 0 for $i = 0 to 200000 \n\
+      $s = $s + 1234567 - 1234566 + 987654321 - 987654320 \n\
+    next print $s stop"
+  }, {
+    "number",
+    ":n = \"-123456789\" $s = 0 for $i = 0 to 200000 \n\
+      $s = $s + number :n + number \"42\" \n\
+    next print $s stop"
+  }, {
+    "print",
+    "for $i = 0 to 100000 print $i * 1000003, \" \", -$i, \"\n\" next stop"
+  }, {
+    "printf",
+    "for $i = 0 to 100000 printf \"%8d %x\n\", $i * 1000003, $i next stop"
+  }
+};
+
+/* Operands of the conversions, a mix of short and long numbers --------- */
+BP_VAR_TYPE values[256];
+char texts[256][BP_NUM_MAX_LENGTH + 2];
+
+double elapsed(uint32_t t) { return (micros() - t) / 1000.0; };
+
+int main() {
+  for(uint16_t i = 0; i < 256; i++) {
+    values[i] = (BP_VAR_TYPE)((i * 2654435761UL) >> (i % 28));
+    if(i & 1) values[i] = -values[i];
+    bp_ltoa(texts[i], values[i], 10);
+  }
+  char n[BP_NUM_MAX_LENGTH + 2];
+  printf("BIPLAN number benchmark, %u conversions\n\n", CONVERSIONS);
+  printf("conversion        host    biplan\n");
+  uint32_t t = micros();
+  for(uint32_t i = 0; i < CONVERSIONS; i++) sink = atol(texts[i & 255]);
+  double host = elapsed(t);
+  t = micros();
+  for(uint32_t i = 0; i < CONVERSIONS; i++) sink = bp_atol(texts[i & 255]);
+  printf("text to number %6.2fms %7.2fms\n", host, elapsed(t));
+  t = micros();
+  for(uint32_t i = 0; i < CONVERSIONS; i++)
+    sink = snprintf(n, sizeof(n), "%ld", (long)values[i & 255]);
+  host = elapsed(t);
+  t = micros();
+  for(uint32_t i = 0; i < CONVERSIONS; i++)
+    sink = bp_ltoa(n, values[i & 255], 10);
+  printf("number to text %6.2fms %7.2fms\n\n", host, elapsed(t));
+
+  FILE *null = fopen("/dev/null", "w");
+  printf("program        time\n");
+  for(uint8_t i = 0; i < (sizeof(tests) / sizeof(test_t)); i++) {
+    static char program[1024];
+    strcpy(program, tests[i].program);
+    compiler.error_callback = error_callback;
+    compiler.run(program);
+    if(compiler.fail) return 1;
+    interpreter.initialize(program, error_callback, null, 0, 0);
+    t = micros();
+    while(!interpreter.finished()) interpreter.run();
+    printf("%-10s %8.2fms\n", tests[i].name, elapsed(t));
+  }
+  fclose(null);
+  return 0;
+};
@@ -0,0 +1,117 @@
+/* Paged program loader benchmark (Linux)
+   Runs the example programs from a paged program memory, varying the
+   amount of pages cached, and reports page hit rate, pages loaded from
+   storage and execution time. Compile from the repository root with:
+
+   g++ -O2 -Isrc examples/LINUX/paged-benchmark/paged-benchmark.cpp \
+     -o paged-benchmark */
+
+#define BP_PAGED
+#define BP_PAGE_SIZE 16
+#define BP_PAGES 16
+
+#include "BCC.h"
+#include "BIPLAN.h"
+
+BCC compiler;
+BIPLAN_Interpreter interpreter;
+
+char *storage;
+uint32_t storage_length;
+
+uint16_t read_page(uint32_t address, uint8_t *data, uint16_t length) {
+  if(address >= storage_length) return 0;
+  if(length > (storage_length - address))
+    length = storage_length - address;
+  memcpy(data, storage + address, length);
+  return length;
+};
+
+void error_callback(char *position, const char *string) {
+  printf("Error: %s\n", string);
+};
+
+char cycles[] =
+"$inc = 0 \n\
+for $i = 0 to 10000 \n\
+ ++$inc \n\
+next \n\
+$inc = 0\n\
+while $inc < 10000 \n\
+  ++$inc \n\
+next \n\
+$inc = 0\n\
+label $loop \n\
+if ++$inc < 10000 jump $loop end \n\
+stop\n";
+
+char functions[] =
+"for $i = 0 to 2000 \n\
+  $r = div(mul(sum($i, 1), 2), 2) \n\
+next \n\
+print \"sum(1, 1) = \", sum(1, 1) \n\
+stop \n\
+function sum($a, $b) \n\
+  return $a + $b \n\
+function mul($a, $b) \n\
+  return $a * $b \n\
+function div($a, $b) \n\
+  return $a / $b \n";
+
+char primes[] =
+"$result = 0 \n\
+for $i = 0 to 3000 \n\
+  if prime($i) \n\
+    print $i, \"\n\" \n\
+    ++$result \n\
+  end \n\
+next \n\
+print \"Prime numbers found: \", $result, \"\n\" \n\
+stop \n\
+function prime($n) \n\
+  if $n <= 1 return 0 end \n\
+  if $n <= 3 return 1 end \n\
+  if ($n % 2 == 0) || ($n % 3 == 0) return 0 end \n\
+  for $u = 2 to sqrt($n) + 1 \n\
+    if($n % $u == 0) return 0 end \n\
+    if $n == $u return 1 end \n\
+  next \n\
+return 1\n";
+
+void benchmark(const char *name, char *program, FILE *output) {
+  compiler.error_callback = error_callback;
+  compiler.run(program);
+  if(compiler.fail) return;
+  storage = program;
+  storage_length = strlen(program);
+  printf("\n%s: %u bytes\n", name, storage_length);
+  printf("pages  cache  hit rate   loads        reads  time\n");
+  for(uint8_t pages = 1; pages <= BP_PAGES; pages *= 2) {
+    bp_pager_t &pager = interpreter.pager;
+    interpreter.initialize(
+      bp_pager_init(pager, read_page, pages), error_callback, output, 0, 0
+    );
+    pager.hits = pager.misses = 0; // Count execution only
+    uint32_t time = micros();
+    while(!interpreter.finished()) interpreter.run();
+    time = micros() - time;
+    printf(
+      "%5u  %4uB  %7u%%  %6u  %11u  %uus\n",
+      pages,
+      pages * BP_PAGE_SIZE,
+      bp_pager_hit_rate(pager),
+      pager.misses,
+      pager.hits + pager.misses,
+      time
+    );
+  }
+};
+
+int main() {
+  FILE *output = fopen("/dev/null", "w");
+  printf("BIPLAN paged program benchmark, %u bytes pages\n", BP_PAGE_SIZE);
+  benchmark("cycles", cycles, output);
+  benchmark("functions", functions, output);
+  benchmark("primes", primes, output);
+  return 0;
+};
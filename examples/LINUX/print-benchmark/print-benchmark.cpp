@@ -0,0 +1,121 @@
+/* Print benchmark (Linux)
+   Runs print-heavy programs writing to /dev/null with a write(2) call for
+   each BPM_PRINT_WRITE and reports the amount of write calls and the time
+   taken. Compile from the repository root with and without the print
+   buffer and compare the results:
+
+   g++ -O2 -Isrc examples/LINUX/print-benchmark/print-benchmark.cpp \
+     -o print-benchmark
+
+   g++ -O2 -Isrc -DBP_PRINT_BUFFER=128 \
+     examples/LINUX/print-benchmark/print-benchmark.cpp -o print-benchmark
+
+   Add -DBP_PRINT_FLUSH_POLICY=BP_FLUSH_FULL to flush only when full. */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+uint32_t writes = 0;
+
+void bench_write(int fd, const char *s) {
+  writes++;
+  if(write(fd, s, strlen(s))) { }
+};
+
+void bench_write(int fd, char c) {
+  writes++;
+  if(write(fd, &c, 1)) { }
+};
+
+void bench_write(int fd, long v) {
+  char s[24];
+  snprintf(s, sizeof(s), "%ld", v);
+  bench_write(fd, s);
+};
+
+#define BPM_PRINT_TYPE int
+#define BPM_PRINT_WRITE(S, C) bench_write(S, C)
+
+#include "BCC.h"
+#include "BIPLAN.h"
+
+BCC compiler;
+BIPLAN_Interpreter interpreter;
+
+void error_callback(char *position, const char *string) {
+  printf("Error: %s\n", string);
+};
+
+struct test_t {
+  const char *name;
+  const char *program;
+};
+
+test_t tests[] = {
+  {
+    "prime",
+    "for $i = 0 to 20000 if prime($i) print $i, \"\n\" end next stop \n\
+    function prime($n) \n\
+      if $n <= 1 return 0 end \n\
+      if $n <= 3 return 1 end \n\
+      if ($n % 2 == 0) || ($n % 3 == 0) return 0 end \n\
+      for $u = 2 to sqrt($n) + 1 \n\
+        if($n % $u == 0) return 0 end \n\
+        if $n == $u return 1 end \n\
+      next \n\
+    return 1"
+  }, {
+    "fibonacci",
+    "for $r = 1 to 500 \n\
+      $a = 0 $b = 1 $f = 0 \n\
+      while $f < 1000000000 \n\
+        print $f, \"\n\" \n\
+        $a = $b $b = $f $f = $a + $b \n\
+      next \n\
+    next stop"
+  }, {
+    "draw-x",
+    "for $r = 1 to 200 \n\
+      for $y = 0 to 19 \n\
+        for $x = 0 to 19 \n\
+          if $x == $y || ($x + $y == 19) print \"X\" else print \" \" end \n\
+        next \n\
+        print \"\n\" \n\
+      next \n\
+    next stop"
+  }, {
+    "table",
+    "for $i = 0 to 5000 print $i, \" \", $i * $i, \" \", -$i, \"\n\" next stop"
+  }
+};
+
+int main() {
+  int fd = open("/dev/null", O_WRONLY);
+  #ifdef BP_PRINT_BUFFER
+    printf(
+      "BIPLAN print benchmark, %u bytes buffer, policy %u\n\n",
+      BP_PRINT_BUFFER, BP_PRINT_FLUSH_POLICY
+    );
+  #else
+    printf("BIPLAN print benchmark, unbuffered\n\n");
+  #endif
+  printf("program        writes      time\n");
+  for(uint8_t i = 0; i < (sizeof(tests) / sizeof(test_t)); i++) {
+    static char program[1024];
+    strcpy(program, tests[i].program);
+    compiler.error_callback = error_callback;
+    compiler.run(program);
+    if(compiler.fail) return 1;
+    interpreter.initialize(program, error_callback, fd, 0, 0);
+    writes = 0;
+    uint32_t time = micros();
+    while(!interpreter.finished()) interpreter.run();
+    time = micros() - time;
+    printf("%-10s %10u %8.2fms\n", tests[i].name, writes, time / 1000.0);
+  }
+  close(fd);
+  return 0;
+};
@@ -0,0 +1,108 @@
+/* Serial transmission benchmark (Linux)
+   Runs serialWrite of a string in a loop on a pseudo terminal and reports
+   messages per second, bytes and write calls per message. The same amount
+   of messages is then sent as the previous implementation did, writing
+   BP_STRING_MAX_LENGTH bytes one at a time, for comparison. Compile from
+   the repository root with:
+
+   g++ -O2 -Isrc examples/LINUX/serial-benchmark/serial-benchmark.cpp \
+     -o serial-benchmark -lpthread */
+
+#include <termios.h>
+#include <atomic>
+
+uint32_t writes = 0;
+void counted_write(int fd, const void *data, uint32_t l);
+
+#define BPM_SERIAL_WRITE_BUF counted_write
+
+#include "BCC.h"
+#include "BIPLAN.h"
+
+#define MESSAGES 20000
+
+BCC compiler;
+BIPLAN_Interpreter interpreter;
+std::atomic<uint64_t> received(0);
+std::atomic<bool> done(false);
+
+void counted_write(int fd, const void *data, uint32_t l) {
+  writes++;
+  bp_linux_write(fd, data, l);
+};
+
+void error_callback(char *position, const char *string) {
+  printf("Error: %s\n", string);
+};
+
+/* Drain the master side of the pseudo terminal ------------------------- */
+void drain(int fd) {
+  uint8_t buffer[4096];
+  while(!done) {
+    struct pollfd p = {fd, POLLIN, 0};
+    if(poll(&p, 1, 10) <= 0) continue;
+    ssize_t n = read(fd, buffer, sizeof(buffer));
+    if(n > 0) received += n;
+  }
+};
+
+/* Wait until the reader received the expected amount of bytes ---------- */
+void wait_for(uint64_t bytes) {
+  while(received < bytes) std::this_thread::yield();
+};
+
+int main() {
+  int master = posix_openpt(O_RDWR | O_NOCTTY);
+  if((master < 0) || grantpt(master) || unlockpt(master)) {
+    printf("Unable to open a pseudo terminal\n");
+    return 1;
+  }
+  int slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+  struct termios t;
+  tcgetattr(slave, &t);
+  cfmakeraw(&t);
+  tcsetattr(slave, TCSANOW, &t);
+  std::thread reader(drain, master);
+
+  static char program[256];
+  snprintf(
+    program, sizeof(program),
+    ":s = \"Hello\" for $r = 1 to %u serialWrite :s next stop", MESSAGES
+  );
+  compiler.error_callback = error_callback;
+  compiler.run(program);
+  if(compiler.fail) return 1;
+  interpreter.initialize(program, error_callback, stdout, 0, slave);
+  uint32_t time = micros();
+  while(!interpreter.finished()) interpreter.run();
+  wait_for((uint64_t)MESSAGES * 5);
+  uint64_t bytes = received;
+  time = micros() - time;
+  printf("BIPLAN serial benchmark, %u messages on %s\n\n", MESSAGES,
+    ptsname(master));
+  printf("path          msg/s    bytes/msg  writes/msg\n");
+  printf(
+    "buffered %10.0f  %9.1f  %10.1f\n",
+    MESSAGES / (time / 1e6), (double)bytes / MESSAGES,
+    (double)writes / MESSAGES
+  );
+
+  received = 0;
+  time = micros();
+  for(uint32_t m = 0; m < MESSAGES; m++)
+    for(uint16_t i = 0; i < BP_STRING_MAX_LENGTH; i++)
+      BPM_SERIAL_WRITE(slave, (i < 5) ? "Hello"[i] : 0);
+  wait_for((uint64_t)MESSAGES * BP_STRING_MAX_LENGTH);
+  time = micros() - time;
+  printf(
+    "per byte %10.0f  %9.1f  %10.1f\n",
+    MESSAGES / (time / 1e6), (double)BP_STRING_MAX_LENGTH,
+    (double)BP_STRING_MAX_LENGTH
+  );
+
+  done = true;
+  reader.join();
+  close(slave);
+  close(master);
+  return 0;
+};
@@ -0,0 +1,87 @@
+/* Large program stress benchmark (Linux)
+   Compiles and runs synthetic programs from 1KB to 16MB and reports how
+   compilation and execution time scale with program size. Compile from
+   the repository root with:
+
+   g++ -O2 -Isrc examples/LINUX/stress-benchmark/stress-benchmark.cpp \
+     -o stress-benchmark */
+
+#include "BCC.h"
+#include "BIPLAN.h"
+
+BCC compiler;
+BIPLAN_Interpreter interpreter;
+
+bool error = false;
+
+void error_callback(char *position, const char *string) {
+  printf("Error: %s\n", string);
+  error = true;
+};
+
+const char block[] =
+"$count = $count + 1\n\
+if $count % 3 == 0 $total = $total + $count else $total = $total - 1 end\n\
+for $i = 0 to 3\n\
+  $cycles = $cycles + $i\n\
+next\n\
+:text = \"stress\"\n\
+$total = sum($total, sizeof :text)\n";
+
+const char head[] =
+"# Synthetic program\n\
+$count = 0\n\
+$total = 0\n\
+$cycles = 0\n";
+
+const char tail[] =
+"print $count, \" \", $total, \" \", $cycles, \"\n\"\n\
+stop\n\
+function sum($a, $b)\n\
+  return $a + $b\n";
+
+// Writes a program of at least size bytes, returns its length
+uint32_t generate(char *program, uint32_t size) {
+  uint32_t length = 0;
+  memcpy(program, head, strlen(head));
+  length += strlen(head);
+  while(length < size) {
+    memcpy(program + length, block, strlen(block));
+    length += strlen(block);
+  }
+  memcpy(program + length, tail, strlen(tail) + 1);
+  return length + strlen(tail);
+};
+
+int main() {
+  const uint32_t max_size = 16UL * 1024 * 1024;
+  char *program = (char *)malloc(max_size + 1024);
+  FILE *output = fopen("/dev/null", "w");
+  printf("BIPLAN large program benchmark\n");
+  printf("    source      BIP  compile ms  ns/byte   run ms  ns/byte\n");
+  for(uint32_t size = 1024; size <= max_size; size *= 2) {
+    uint32_t length = generate(program, size);
+    uint64_t time = micros();
+    compiler.error_callback = error_callback;
+    compiler.run(program);
+    uint64_t compile = micros() - time;
+    if(compiler.fail || error) return 1;
+    uint32_t bip = strlen(program);
+    time = micros();
+    interpreter.initialize(program, error_callback, output, 0, 0);
+    while(!interpreter.finished()) interpreter.run();
+    uint64_t run = micros() - time;
+    if(error) return 1;
+    printf(
+      "%10u %8u %11.1f %8.1f %8.1f %8.1f\n",
+      length,
+      bip,
+      compile / 1000.0,
+      (compile * 1000.0) / length,
+      run / 1000.0,
+      (run * 1000.0) / bip
+    );
+  }
+  free(program);
+  return 0;
+};
@@ -0,0 +1,80 @@
+#include "BCC.h"
+#include "BIPLAN.h"
+
+BCC compiler;
+BIPLAN_Interpreter interpreter;
+
+bool error = false;
+
+void error_callback(char *position, const char *string) {
+  Serial.print("error: ");
+  Serial.print(string);
+  if(position) {
+    Serial.print(" ");
+    Serial.print(*position);
+    Serial.print(" at position ");
+    Serial.print(position - interpreter.program_start);
+  }
+  Serial.println();
+  error = true;
+};
+
+/* Native functions, the arguments are received already evaluated -------- */
+
+BP_VAR_TYPE led(BP_VAR_TYPE *args) {
+  digitalWrite(13, args[0]);
+  return args[0];
+};
+
+BP_VAR_TYPE clamp(BP_VAR_TYPE *args) {
+  return constrain(args[0], args[1], args[2]);
+};
+
+BP_VAR_TYPE uptime(BP_VAR_TYPE *args) { return millis() / 1000; };
+
+bp_native_t natives[] = {
+  {"led", led, 1},
+  {"clamp", clamp, 3},
+  {"uptime", uptime, 0}
+};
+
+char program[] =
+"print \"\nBIPLAN native functions test start...\" \n\
+print \"\nclamp(150, 0, 100): \", clamp(150, 0, 100) \n\
+for $i = 0 to 4 \n\
+  led(HIGH) \n\
+  delay 500 \n\
+  led(LOW) \n\
+  delay 500 \n\
+next \n\
+print \"\nuptime: \", uptime(), \" seconds\" \n\
+print \"\nBIPLAN native functions test finished.\" \n\
+stop\n";
+
+void setup() {
+  pinMode(13, OUTPUT);
+  Serial.begin(115200);
+  // Bind the same table to compiler and interpreter
+  compiler.natives = interpreter.natives = natives;
+  compiler.native_count = interpreter.native_count = 3;
+  compiler.error_callback = error_callback;
+  compiler.run(program);
+  interpreter.initialize(
+    program,
+    error_callback,
+    &Serial,
+    &Serial,
+    &Serial
+  );
+  // Check for compilation errors
+  if(error) {
+    interpreter.ended = true;
+    Serial.println("Fix your code and retry.");
+  }
+}
+
+void loop() {
+  while(!interpreter.ended)
+    interpreter.run();
+  while(true);
+}
@@ -0,0 +1,75 @@
+#define BP_TIMERS 2
+#include "BCC.h"
+#include "BIPLAN.h"
+
+BCC compiler;
+BIPLAN_Interpreter interpreter;
+
+bool error = false;
+
+void error_callback(char *position, const char *string) {
+  Serial.print("error: ");
+  Serial.print(string);
+  if(position) {
+    Serial.print(" ");
+    Serial.print(*position);
+    Serial.print(" at position ");
+    Serial.print(position - interpreter.program_start);
+  }
+  Serial.println();
+  error = true;
+};
+
+/* blink is called every 250 milliseconds, also while wait_blinks waits
+   for it within a function. */
+
+char program[] =
+"print \"\nBIPLAN periodic calls test start...\" \n\
+$n = 0 \n\
+every 250 call blink \n\
+wait_blinks(10) \n\
+every 0 call blink \n\
+print \"\nblinks: \", $n \n\
+print \"\nBIPLAN periodic calls test finished.\" \n\
+stop \n\
+function blink() \n\
+  digitalWrite 13, not digitalRead 13 \n\
+  $n = $n + 1 \n\
+return 0 \n\
+function wait_blinks($b) \n\
+  while $n < $b next \n\
+return 0\n";
+
+void setup() {
+  pinMode(13, OUTPUT);
+  Serial.begin(115200);
+  compiler.error_callback = error_callback;
+  compiler.run(program);
+  interpreter.initialize(
+    program,
+    error_callback,
+    &Serial,
+    &Serial,
+    &Serial
+  );
+  // Check for compilation errors
+  if(error) {
+    interpreter.ended = true;
+    Serial.println("Fix your code and retry.");
+  }
+}
+
+void loop() {
+  while(!interpreter.ended)
+    interpreter.run();
+  // Statistics of the timer, kept in its slot after every 0
+  bp_timer_t &t = interpreter.timers[0];
+  Serial.print("\ncalls: ");
+  Serial.print(t.runs);
+  Serial.print(" skipped periods: ");
+  Serial.print(t.overruns);
+  Serial.print(" max jitter: ");
+  Serial.print(t.jitter_max);
+  Serial.println("ms");
+  while(true);
+}
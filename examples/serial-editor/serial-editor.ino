@@ -15,13 +15,13 @@ uint16_t line_number = 0;
 uint8_t line_offset = 0;
 uint8_t char_index = 0;
 
-void shift_left(uint16_t index, uint16_t offset) {
+void shift_left(uint32_t index, uint32_t offset) {
   Serial.print("Index: ");
   Serial.print(index);
   Serial.print(" Offset: ");
   Serial.println(offset);
 
-  for(uint16_t i = 0; (i + index) < MAX_PROG_SIZE; i++) {
+  for(uint32_t i = 0; (i + index) < MAX_PROG_SIZE; i++) {
     program[(index - offset) + i] = program[index + i];
   }
   //for(uint16_t i = index + offset; i < index + offset + offset; i++)
@@ -33,25 +33,27 @@ void empty_line() {
 };
 
 void empty_program() {
-  for(uint16_t i = 0; i < MAX_PROG_SIZE; i++) program[i] = ' ';
+  for(uint32_t i = 0; i < MAX_PROG_SIZE; i++) program[i] = ' ';
 };
 
-uint16_t find_line_length(uint16_t index) {
-  for(uint8_t i = index; i < MAX_LINE_SIZE; i++)
+uint32_t find_line_length(uint32_t index) {
+  uint32_t end = index + MAX_LINE_SIZE;
+  for(uint32_t i = index; (i < end) && (i < MAX_PROG_SIZE); i++)
     if(program[i] == '\n') return (i - index);
   return 0;
 };
 
-uint16_t find_last_line() {
-  for(uint16_t i = MAX_PROG_SIZE - 1; i > 0; i--)
+uint32_t find_last_line() {
+  for(uint32_t i = MAX_PROG_SIZE - 1; i > 0; i--)
     if(program[i] == '\n') return i;
+  return 0;
 };
 
-uint16_t find_line(uint16_t line) {
+uint32_t find_line(uint16_t line) {
   //Serial.print("Requested line: ");
   //Serial.println(line);
-  uint16_t result = 0;
-  for(uint16_t i = 0; (i < MAX_PROG_SIZE) && (line - 1); i++)
+  uint32_t result = 0;
+  for(uint32_t i = 0; (i < MAX_PROG_SIZE) && (line - 1); i++)
     if(program[i] == '\n') {
       result = i;
       line--;
@@ -62,7 +64,7 @@ uint16_t find_line(uint16_t line) {
 
 void run() {
   Serial.print(program);
-  uint16_t length;
+  uint32_t length;
   for(length = 0; program[length] != 0; length++);
   Serial.println("--------------------------");
   Serial.print("Program length: ");
@@ -71,11 +73,11 @@ void run() {
   Serial.println();
   uint32_t time = millis();
 
-  bcc.compile(program);
+  bcc.run(program);
   interpreter.initialize(program, error_callback, &Serial, &Serial, &Serial);
 
   Serial.print(program);
-  uint16_t new_length;
+  uint32_t new_length;
   for(new_length = 0; program[new_length] != 0; new_length++);
   Serial.println("--------------------------");
   Serial.print("Compilation duration: ");
@@ -134,7 +136,7 @@ void loop() {
     if(c == '\n') {
       //if(line_number) program[find_line(line_number) + char_index] = c;
       if(line_number) {
-        uint8_t l = find_line_length(find_line(line_number));
+        uint32_t l = find_line_length(find_line(line_number));
         //Serial.print("Line length: ");
         //Serial.print(l);
         //Serial.print(" Input length: ");
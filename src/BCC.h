@@ -28,15 +28,43 @@
   limitations under the License. */
 
 #pragma once
+#include <stdio.h>
 #include "BIPLAN_Defines.h"
+#include "BIPLAN_Container.h"
 #include "BCC.h"
 
 class BCC {
 public:
-  char var_id = BP_OFFSET;
-  char string_id = BP_OFFSET;
-  char fun_id = BP_OFFSET;
+  /* TYPES ----------------------------------------------------------------- */
+  struct requirements_t {
+    uint16_t variables = 0;    // Numeric variables used
+    uint16_t strings = 0;      // Strings used
+    uint16_t functions = 0;    // Functions defined
+    uint16_t params = 0;       // Maximum amount of parameters of a function
+    uint16_t cycle_depth = 0;  // Maximum for/while nesting (across calls)
+    uint16_t call_depth = 0;   // Maximum static function call depth
+    bool     recursive = false;
+    uint32_t memory = 0;       // Memory high-water mark
+  };
+
+  // Names encoded, one byte ids are reserved to names too short for two
+  struct ids_t {
+    uint16_t names = 0;
+    uint16_t short_names = 0;
+    uint16_t reserved = 0;
+    uint16_t count() { return names + short_names; };
+  };
+
+  requirements_t requirements;
+  ids_t var_ids;
+  ids_t string_ids;
+  ids_t fun_ids;
   error_type error_callback = NULL;
+  const bp_native_t *natives = NULL; // Native functions (see encode_natives)
+  uint16_t native_count = 0;
+  char *symbols = NULL;        // Exported names and ids (see export_symbol)
+  uint32_t symbols_size = 0;
+  uint32_t symbols_length = 0;
   bool fail = false;
 
   BCC() { };
@@ -54,8 +82,8 @@ public:
 
   /* CHECK DELIMETERS ------------------------------------------------------ */
   bool check_delimeter(char *program, char a, char b) {
-    uint16_t ia = 0;
-    uint16_t ib = 0;
+    uint32_t ia = 0;
+    uint32_t ib = 0;
     char *p = program;
     while(*p != 0) {
       if((*p == a) && !is_in_string(program, p)) ia++;
@@ -64,19 +92,32 @@ public:
     } return (ia == ib);
   };
 
-  /* CHECK IF POINTER IS IN A STRING -------------------------------------- */
+  /* CHECK IF POINTER IS IN A STRING --------------------------------------
+     Positions are mostly checked in ascending order, the scan resumes from
+     the last position checked, so each pass is linear in program length.
+     Encoding never adds or removes string delimiters, functions that move
+     the program in the buffer call reset_string_scan. */
+  char *string_scan = NULL;
+  char *string_scan_program = NULL;
+  bool  string_scan_in = false;
+
+  void reset_string_scan() { string_scan_program = NULL; };
+
   bool is_in_string(char *program, char *a) {
-    bool in_str = false;
-    char *p = program;
-    while(a > p) {
-      if(*p == BP_STRING) in_str = !in_str;
-      p++;
-    } return in_str;
+    if((program != string_scan_program) || (a < string_scan)) {
+      string_scan_program = string_scan = program;
+      string_scan_in = false;
+    }
+    while(a > string_scan) {
+      if(*string_scan == BP_STRING) string_scan_in = !string_scan_in;
+      string_scan++;
+    } return string_scan_in;
   };
 
   /* REMOVE SPACES FROM PROGRAM ------------------------------------------- */
   void remove_spaces(char *s) {
     if(fail) return; // Abort if an error occurred
+    reset_string_scan();
     char *i = s;
     char *j = s;
     bool in_str = false;
@@ -91,6 +132,7 @@ public:
   /* REMOVE CARRIAGE RETURN FROM PROGRAM ---------------------------------- */
   void remove_cr(char *s) {
     if(fail) return; // Abort if an error occurred
+    reset_string_scan();
     char *i = s;
     char *j = s;
     bool in_str = false;
@@ -105,6 +147,7 @@ public:
   /* REMOVE COMMENTS FROM PROGRAM ----------------------------------------- */
   void remove_comments(char *s) {
     if(fail) return; // Abort if an error occurred
+    reset_string_scan();
     char *i = s;
     char *j = s;
     bool in_str = false;
@@ -115,7 +158,7 @@ public:
       else {
         if(in_str) i++;
         else {
-          while(*j != BP_CR) (void)(*j++);
+          while(*j && (*j != BP_CR)) (void)(*j++);
           //(void)(*j++);
         }
       }
@@ -130,8 +173,8 @@ public:
     const char *code
   ) {
     char *p;
-    uint8_t kl = strlen(keyword);
-    uint8_t cl = strlen(code);
+    uint16_t kl = strlen(keyword);
+    uint16_t cl = strlen(code);
     p = strstr(position, keyword);
     if(p && *p) {
       if(is_in_string(program, p)) {
@@ -161,62 +204,143 @@ public:
       encode_pass(program, position, keyword, (const char *)c);
   };
 
+  /* TYPED MEMORY VIEWS: @16[ -> W16[, @s16[ -> X16[ -------------------- */
+  void encode_mem_views(char *program) {
+    const char *w[4] = {"8[", "16[", "32[", "64["};
+    char k[6], c[5];
+    for(uint8_t i = 0; i < 4; i++) {
+      strcpy(k, BP_MEM_SVIEW_HUMAN);
+      strcpy(k + 2, w[i]);
+      c[0] = BP_MEM_SVIEW;
+      strcpy(c + 1, w[i]);
+      encode(program, k, c);
+      strcpy(k + 1, w[i]);
+      c[0] = BP_MEM_VIEW;
+      encode(program, k, c);
+    }
+  };
+
+  /* ID ASSIGNMENT (see BP_EXTENDED) -------------------------------------
+     Names are encoded longest first, short names get the last one byte
+     ids, so ids are contiguous and programs with less than BP_SHORT_IDS
+     names use only one byte ids. */
+  uint16_t next_id(ids_t &ids, bool short_name) {
+    uint16_t first = BP_SHORT_IDS - ids.reserved;
+    if(short_name)
+      return ((ids.names < first) ? ids.names : first) + ids.short_names;
+    return (ids.names < first) ? ids.names : ids.names + ids.reserved;
+  };
+
+  /* WRITE AN ID PLACEHOLDER ----------------------------------------------
+     Ids are written outside the ASCII range so the following encoding
+     passes can't alter them, encode_ids translates one byte ids at the
+     end of compilation. */
+  uint8_t write_id(char *code, uint16_t id) {
+    if(id < BP_SHORT_IDS) {
+      code[0] = (char)(128 + id);
+      return 1;
+    }
+    id -= BP_SHORT_IDS;
+    code[0] = (char)(BP_EXTENDED + (id >> 7));
+    code[1] = (char)(128 + (id & 127));
+    return 2;
+  };
+
+  void encode_ids(char *program) {
+    if(fail) return; // Abort if an error occurred
+    bool in_str = false;
+    for(uint8_t *p = (uint8_t *)program; *p; p++) {
+      if(*p == BP_STRING) in_str = !in_str;
+      if(in_str || (*p < 128)) continue;
+      if(*p >= BP_EXTENDED) p++;
+      else *p = *p - 128 + BP_OFFSET;
+    }
+  };
+
+  /* READ THE ID OF THE CODE AT p ----------------------------------------- */
+  uint16_t read_id(const char *p) {
+    uint8_t b = *(p + 1);
+    if(b < BP_EXTENDED) return b - BP_OFFSET;
+    return BP_SHORT_IDS + ((uint16_t)(b - BP_EXTENDED) << 7) +
+      ((uint8_t)*(p + 2) & 127);
+  };
+
+  /* EXPORT NAME AND ID OF A VARIABLE OR STRING -------------------------
+     If symbols is set each name encoded is appended to it as "$name" or
+     ":name", its null terminator and the id (2 bytes little-endian). The
+     table is terminated by an empty name, see BIPLAN_Interpreter::symbol. */
+  void export_symbol(const char *name, uint16_t id) {
+    if(!symbols || fail) return;
+    uint32_t l = strlen(name) + 1;
+    if((symbols_length + l + 3) > symbols_size) {
+      error(0, BP_ERROR_SYMBOLS);
+      fail = true;
+      return;
+    }
+    memcpy(symbols + symbols_length, name, l);
+    symbols[symbols_length + l] = id & 0xFF;
+    symbols[symbols_length + l + 1] = id >> 8;
+    symbols_length += l + 2;
+    symbols[symbols_length] = 0;
+  };
+
   /* ENCODE PROGRAM VARIABLE IN BYTECODE ---------------------------------- */
-  char *minifier_variable_pass(char *program, char *position, bool var_type) {
+  bool minifier_variable_pass(char *program, bool var_type) {
     char *p;
     char str[BP_MAX_KEYWORD_LENGTH];
     char code[4] = {(var_type) ? BP_ADDRESS : BP_S_ADDRESS, 0, 0, 0};
-    uint8_t n;
-    if((p = find_longest_var_name(program, var_type)) != NULL) {
-      str[0] = (var_type) ? BP_ADDRESS : BP_S_ADDRESS;
-      p++;
-      str[1] = *p;
-      *p = (var_type) ? var_id : string_id;
-      p++;
-      n = 2;
-      for(uint16_t i = 0; i < BP_MAX_KEYWORD_LENGTH - 1; i++, p++) {
-        if(keyword_char(*p)) {
-          // Add space instead of keyword (will be removed by remove_spaces)
-          str[n++] = *p;
-          *p = BP_SPACE;
-          // Check maximum variable name length
-          if((i == (BP_MAX_KEYWORD_LENGTH - 2)) && keyword_char(*(p + 1))) {
-            error(0, BP_ERROR_VARIABLE_NAME);
-            fail = true;
-            return NULL;
-          }
-        } else break;
+    ids_t &ids = (var_type) ? var_ids : string_ids;
+    uint16_t n = 1;
+    if((p = find_longest_var_name(program, var_type)) == NULL) return false;
+    str[0] = code[0];
+    for(p++; keyword_char(*p); p++) {
+      // Check maximum variable name length
+      if(n == (BP_MAX_KEYWORD_LENGTH - 1)) {
+        error(0, BP_ERROR_VARIABLE_NAME);
+        fail = true;
+        return false;
       }
-      if(n) {
-        // Encode variable address followed by space " "
-        str[n] = 0;
-        code[1] = (var_type) ? var_id : string_id;
-        code[2] = 0;
-        encode(position, str, code);
-        p = strstr(position, str);
-        if((p && *p) && !is_in_string(program, p)) return p;
-        if(var_type) var_id++; else string_id++;
-        return (char *)position;
-      } return p;
-    } return NULL;
+      str[n++] = *p;
+    }
+    str[n] = 0;
+    // Encode variable address followed by spaces (removed by remove_spaces)
+    write_id(code + 1, next_id(ids, n == 2));
+    export_symbol(str, next_id(ids, n == 2));
+    encode(program, str, code);
+    if(n == 2) ids.short_names++; else ids.names++;
+    return true;
   };
 
   void encode_variables(char *program, bool type) {
     if(fail) return; // Abort if an error occurred
-    char *position = program;
-    while(position) position =
-      minifier_variable_pass(program, position, type);
+    uint64_t letters = 0;
+    bool in_str = false;
+    ids_t &ids = (type) ? var_ids : string_ids;
+    // Single letter names can only hold a one byte id
+    for(char *p = program; *p; p++) {
+      if(*p == BP_STRING) in_str = !in_str;
+      if(
+        in_str || (*p != ((type) ? BP_ADDRESS : BP_S_ADDRESS)) ||
+        !keyword_char(*(p + 1)) || keyword_char(*(p + 2))
+      ) continue;
+      char c = *(p + 1);
+      if(c == '_') letters |= 1ULL << 52;
+      else if(c >= 'a') letters |= 1ULL << (c - 'a' + 26);
+      else letters |= 1ULL << (c - 'A');
+    }
+    for(ids.reserved = 0; letters; letters &= letters - 1) ids.reserved++;
+    while(minifier_variable_pass(program, type));
   };
 
   char *find_longest_var_name(char *program, bool type) {
     char   *position = program;
-    uint8_t result = 0;
+    uint32_t result = 0;
     char   *result_position = 0;
     while(*position != 0) {
       if(*(position++) == ((type) ? BP_ADDRESS : BP_S_ADDRESS)) {
         // Avoid substitution in strings
         if(is_in_string(program, position)) continue;
-        uint8_t i = 0;
+        uint32_t i = 0;
         while(keyword_char(*position)) {
           i++;
           position++;
@@ -232,59 +356,368 @@ public:
     else return NULL;
   };
 
-  /* ENCODE FUNCTION IN BYTECODE ------------------------------------------ */
-  char *encode_function_pass(char *program, char *position) {
+  /* ENCODE FUNCTION IN BYTECODE ------------------------------------------
+     Calls replace the name, names shorter than 3 characters can't hold a
+     two bytes id and are encoded after the others. */
+  char *function_name(char *p, uint32_t &length) {
+    p += strlen(BP_FUN_DEF_HUMAN);
+    while(*p == BP_SPACE) p++;
+    for(length = 0; p[length] && (p[length] != BP_L_RPARENT); length++);
+    while(length && (p[length - 1] == BP_SPACE)) length--;
+    return p;
+  };
+
+  void encode_function(char *program, char *p, bool short_names) {
     char function_keyword[BP_MAX_KEYWORD_LENGTH];
-    char function_address[3];
-    char *p = strstr(position, BP_FUN_DEF_HUMAN);
-    uint8_t keyword_length = 0;
-    if(p && *p) {
-      if(is_in_string(program, p)) {
-        p = strstr(p + 1, BP_FUN_DEF_HUMAN);
-        if(p && *p) return p;
-        else return NULL;
+    char function_address[4] = {BP_FUNCTION, 0, 0, 0};
+    uint32_t keyword_length;
+    char *name = function_name(p, keyword_length);
+    if(!keyword_length || (short_names != (keyword_length < 3))) return;
+    // Check keyword length
+    if(keyword_length >= BP_MAX_KEYWORD_LENGTH) {
+      error(0, BP_ERROR_FUNCTION_NAME);
+      fail = true;
+      return;
+    }
+    memcpy(function_keyword, name, keyword_length);
+    function_keyword[keyword_length] = 0;
+    write_id(function_address + 1, next_id(fun_ids, short_names));
+    // Encode definition, "function name" is replaced by f and the id
+    for(char *d = p; d < (name + keyword_length); d++) *d = BP_SPACE;
+    *p = BP_FUN_DEF;
+    memcpy(p + 1, function_address + 1, strlen(function_address + 1));
+    // Encode calls
+    encode(program, function_keyword, function_address);
+    if(short_names) fun_ids.short_names++; else fun_ids.names++;
+  };
+
+  void encode_functions(char *program) {
+    if(fail) return; // Abort if an error occurred
+    uint32_t length;
+    char *p;
+    fun_ids.reserved = 0;
+    for(p = program; (p = strstr(p, BP_FUN_DEF_HUMAN)) != NULL; p++)
+      if(!is_in_string(program, p)) {
+        function_name(p, length);
+        if(length && (length < 3)) fun_ids.reserved++;
       }
-      *p = BP_FUN_DEF;
-      p++;
-      *p = fun_id;
+    if(fun_ids.reserved > BP_SHORT_IDS) {
+      error(0, BP_ERROR_FUNCTION_NAME);
+      fail = true;
+      return;
+    }
+    for(uint8_t short_names = 0; short_names < 2; short_names++)
+      for(p = program; (p = strstr(p, BP_FUN_DEF_HUMAN)) != NULL; p++)
+        if(!is_in_string(program, p))
+          encode_function(program, p, short_names);
+  };
+
+  /* ENCODE NATIVE FUNCTION CALLS ----------------------------------------
+     Calls of natives[i].name are replaced by BP_NATIVE and the id i, the
+     interpreter must be bound to the same table. Names are replaced only
+     if not part of a longer name. */
+  void encode_natives(char *program) {
+    if(fail || !natives) return; // Abort if an error occurred
+    char code[3] = {BP_NATIVE, 0, 0};
+    if(native_count > BP_MAX_IDS) {
+      error(0, BP_ERROR_NATIVE);
+      fail = true;
+      return;
+    }
+    for(uint16_t i = 0; i < native_count; i++) {
+      uint16_t l = strlen(natives[i].name);
+      uint8_t cl = write_id(code + 1, i) + 1;
+      if(l < cl) {
+        error(0, BP_ERROR_FUNCTION_NAME);
+        fail = true;
+        return;
+      }
+      for(char *p = program; (p = strstr(p, natives[i].name)); p += l) {
+        if(
+          is_in_string(program, p) || keyword_char(p[l]) ||
+          ((p > program) && keyword_char(*(p - 1)))
+        ) continue;
+        memcpy(p, code, cl);
+        memset(p + cl, BP_SPACE, l - cl);
+      }
+    }
+  };
+
+  /* GET THE POSITION OF THE NEXT BIP CODE -------------------------------- */
+  char *next_code(char *p) {
+    if(*p == BP_STRING) {
       p++;
-      while(*p != BP_SPACE) {
-        *p = BP_SPACE;
-        p++;
+      while(*p && (*p != BP_STRING)) p++;
+      return (*p) ? p + 1 : p;
+    }
+    if(*p >= '0' && *p <= '9') {
+      while(*p >= '0' && *p <= '9') p++;
+      return p;
+    }
+    if(
+      *p == BP_ADDRESS || *p == BP_S_ADDRESS ||
+      *p == BP_FUNCTION || *p == BP_FUN_DEF || *p == BP_NATIVE
+    ) {
+      if(!*(p + 1)) return p + 1;
+      if(((uint8_t)*(p + 1) < BP_EXTENDED) || !*(p + 2)) return p + 2;
+      return p + 3;
+    } return p + 1;
+  };
+
+  /* PRINTF FORMATS -------------------------------------------------------
+     The format following printf is compiled in segments, placeholders are
+     replaced by their type and width (see BP_FMT_NUMBER) and %% by %, so
+     the interpreter does not parse it. Segments are never longer than the
+     text they replace, the program is compacted in a single pass. */
+  void encode_formats(char *program) {
+    if(fail) return; // Abort if an error occurred
+    reset_string_scan();
+    char *i = program, *j = program, *n, *t;
+    bool format = false;
+    uint16_t w;
+    while(*j) {
+      n = next_code(j);
+      if(!format || (*j != BP_STRING)) {
+        format = (*j == BP_PRINTF);
+        while(j < n) *(i++) = *(j++);
+        continue;
+      }
+      format = false;
+      while(j < n) {
+        if((*j != '%') || (j == (n - 1))) {
+          *(i++) = *(j++);
+          continue;
+        }
+        if(*(j + 1) == '%') {
+          *(i++) = '%';
+          j += 2;
+          continue;
+        }
+        for(w = 0, t = j + 1; (*t >= '0') && (*t <= '9'); t++)
+          if((w = (w * 10) + (*t - '0')) > BP_FMT_MAX_WIDTH) break;
+        switch(((t < (n - 1)) && (w <= BP_FMT_MAX_WIDTH)) ? *t : 0) {
+          case 'd': *(i++) = BP_FMT_NUMBER; break;
+          case 'x': *(i++) = BP_FMT_HEX; break;
+          case 'c': *(i++) = BP_FMT_CHAR; break;
+          case 's': *(i++) = BP_FMT_STRING; break;
+          default:
+            *i = 0;
+            fail = true;
+            return error(0, BP_ERROR_FORMAT);
+        }
+        *(i++) = (w + 1) | ((*(j + 1) == '0') ? BP_FMT_ZERO : 0);
+        j = t + 1;
+      }
+    } *i = 0;
+  };
+
+  /* COMPUTE PROGRAM REQUIREMENTS ----------------------------------------- */
+  void compute_requirements(char *program) {
+    uint16_t call[BP_MAX_FUNCTIONS + 1], cycle[BP_MAX_FUNCTIONS + 1];
+    uint16_t f = BP_MAX_FUNCTIONS, id, params;
+    uint16_t depth = 0;
+    bool changed = true;
+    char *p;
+    requirements = requirements_t();
+    requirements.variables = var_ids.count();
+    requirements.strings = string_ids.count();
+    requirements.functions = fun_ids.count();
+    for(uint16_t i = 0; i <= BP_MAX_FUNCTIONS; i++) call[i] = cycle[i] = 0;
+    // Parameters, local cycle depth and memory high-water mark
+    for(p = program; *p; p = next_code(p)) {
+      if(*p == BP_FUN_DEF) {
+        f = read_id(p);
+        depth = 0;
+        for(params = 0, p = next_code(p); *p && (*p != BP_R_RPARENT); )
+          if(*p == BP_ADDRESS) { params++; p = next_code(p); } else p++;
+        if(params > requirements.params) requirements.params = params;
+        if(!*p) break;
       }
-      while(p++ && (*p != BP_L_RPARENT)) {
-        function_keyword[keyword_length] = *p;
-        *p = BP_SPACE;
-        keyword_length++;
+      if(*p == BP_FOR || *p == BP_WHILE) {
+        if(++depth > cycle[f]) cycle[f] = depth;
+      } else if((*p == BP_NEXT) && depth) depth--;
+      if(
+        *p == BP_MEMFILL || *p == BP_MEMCOPY || *p == BP_MEMSUM ||
+        *p == BP_MEMMINMAX || *p == BP_MEMSCALE || *p == BP_MEMDOT ||
+        *p == BP_ABURST || *p == BP_SHIFT_OUT
+      ) requirements.memory = BP_MEM_SIZE; // Ranges of dynamic length
+      if(*p == BP_MEM_ACCESS || *p == BP_MEM_VIEW || *p == BP_MEM_SVIEW) {
+        char *i = p + 1;
+        uint32_t v = 0, w = 8;
+        if(*p != BP_MEM_ACCESS) { // Typed view, element size in bits
+          for(w = 0; *i >= '0' && *i <= '9'; i++) w = (w * 10) + (*i - '0');
+          if((w < 8) || (w > 64) || (*(i++) != BP_ACCESS)) w = 8;
+        }
+        char *n = i;
+        while(*i >= '0' && *i <= '9') v = (v * 10) + (*(i++) - '0');
+        v = (v + 1) * (w / 8);
+        if((i == n) || (*i != BP_ACCESS_END)) v = BP_MEM_SIZE;
+        if(v > requirements.memory) requirements.memory = v;
       }
-      if(keyword_length) {
-        // Check keyword length
-        if(keyword_length >= BP_MAX_KEYWORD_LENGTH) {
-          error(0, BP_ERROR_FUNCTION_NAME);
-          fail = true;
-          return NULL;
+    }
+    // Call and cycle depth across calls, relaxed until stable
+    for(uint16_t pass = 0; changed && (pass <= BP_MAX_FUNCTIONS); pass++) {
+      changed = false;
+      f = BP_MAX_FUNCTIONS;
+      depth = 0;
+      for(p = program; *p; p = next_code(p)) {
+        if(*p == BP_FUN_DEF) { f = read_id(p); depth = 0; }
+        if(*p == BP_FOR || *p == BP_WHILE) depth++;
+        else if((*p == BP_NEXT) && depth) depth--;
+        if((*p != BP_FUNCTION) || !*(p + 1)) continue;
+        id = read_id(p);
+        if(id >= BP_MAX_FUNCTIONS) continue;
+        if((call[id] + 1) > call[f] && call[id] < 0xFFFF) {
+          call[f] = call[id] + 1;
+          changed = true;
         }
-        // Encode address
-        function_keyword[keyword_length] = 0;
-        function_address[0] = BP_FUNCTION;
-        function_address[1] = fun_id++;
-        function_address[2] = 0;
-        encode(program, function_keyword, function_address);
-        p = strstr(position, function_keyword);
-        if(p && *p) return p;
-        else return NULL;
-      } return p;
-    } else return NULL;
+        if((depth + cycle[id]) > cycle[f] && (depth + cycle[id]) < 0xFFFF) {
+          cycle[f] = depth + cycle[id];
+          changed = true;
+        }
+      }
+    } // Still changing after as many passes as functions: recursion
+    requirements.recursive = changed;
+    requirements.call_depth = call[BP_MAX_FUNCTIONS];
+    requirements.cycle_depth = cycle[BP_MAX_FUNCTIONS];
   };
 
-  void encode_functions(char *program) {
-    if(fail) return; // Abort if an error occurred
-    char *position = program;
-    while(position) position = encode_function_pass(program, position);
+  /* WRITE REQUIREMENTS AS CONFIGURATION HEADER --------------------------- */
+  int requirements_header(char *buffer, size_t length) {
+    const requirements_t &r = requirements;
+    #define BP_REQ_MIN(V) ((V) ? (unsigned long)(V) : 1UL)
+    return snprintf(
+      buffer,
+      length,
+      "#define BP_VARIABLES %lu\n#define BP_STRINGS %lu\n"
+      "#define BP_MAX_FUNCTIONS %lu\n#define BP_PARAMS %lu\n"
+      "#define BP_CYCLE_DEPTH %lu\n#define BP_FUN_DEPTH %lu\n"
+      "#define BP_MEM_SIZE %lu\n",
+      BP_REQ_MIN(r.variables),
+      BP_REQ_MIN(r.strings),
+      BP_REQ_MIN(r.functions),
+      BP_REQ_MIN(r.params),
+      r.recursive ? BP_CYCLE_DEPTH : BP_REQ_MIN(r.cycle_depth),
+      r.recursive ? BP_FUN_DEPTH : BP_REQ_MIN(r.call_depth),
+      BP_REQ_MIN(r.memory)
+    );
+    #undef BP_REQ_MIN
+  };
+
+  /* FIND WHERE THE BLOCK OPENED AT p CONTINUES ------------------------- */
+  char *block_match(char *p) {
+    uint32_t depth = 1;
+    bool cycle = (*p == BP_FOR) || (*p == BP_WHILE);
+    for(p = next_code(p); *p; p = next_code(p)) {
+      if(cycle) {
+        if(*p == BP_FOR || *p == BP_WHILE) depth++;
+        if((*p == BP_NEXT) && !--depth) return p;
+      } else {
+        if(*p == BP_IF) depth++;
+        if((*p == BP_ELSE) && (depth == 1)) return p;
+        if((*p == BP_ENDIF) && !--depth) return next_code(p);
+      }
+    } return NULL;
+  };
+
+  /* PACK COMPILED PROGRAM IN A BIP CONTAINER (see BIPLAN_Container.h) --- */
+  uint32_t pack(char *program, uint8_t *image, uint32_t size) {
+    // Entries of functions, labels, blocks, constants and strings tables
+    uint32_t n[5] = {0, 0, 0, 0, 0}, c[5] = {0, 0, 0, 0, 0};
+    uint32_t length = strlen(program), functions_size = 0, body = 0, a;
+    const uint8_t entry[5] = {
+      0,
+      BP_IMAGE_LABEL_SIZE,
+      BP_IMAGE_BLOCK_SIZE,
+      BP_IMAGE_CONSTANT_SIZE,
+      BP_IMAGE_STRING_SIZE
+    };
+    char *p, *m;
+    if(fail) return 0;
+    // The first pass counts the entries, the second writes them
+    for(uint8_t pass = 0; pass < 2; pass++) {
+      if(pass) {
+        c[0] = BP_IMAGE_HEADER;
+        c[1] = c[0] + functions_size;
+        for(uint8_t t = 2; t < 5; t++)
+          c[t] = c[t - 1] + ((uint32_t)n[t - 1] * entry[t - 1]);
+        body = c[4] + ((uint32_t)n[4] * entry[4]);
+        if((body + length + 1) > size) return 0;
+      }
+      for(p = program; *p; p = next_code(p)) {
+        a = p - program;
+        if(*p == BP_FUN_DEF) {
+          uint8_t count = 0;
+          for(m = next_code(p); *m && (*m != BP_R_RPARENT); )
+            if(*m == BP_ADDRESS) {
+              if(pass)
+                bp_image_write16(image + c[0] + 7 + (count * 2), read_id(m));
+              count++;
+              m = next_code(m);
+            } else m++;
+          if(pass) {
+            bp_image_write16(image + c[0], read_id(p));
+            bp_image_write32(image + c[0] + 2, ((*m) ? m + 1 : m) - program);
+            image[c[0] + 6] = count;
+            c[0] += 7 + (count * 2);
+          } else functions_size += 7 + (count * 2);
+          n[0] += !pass;
+        } else if((*p == BP_LABEL) && *(p + 1) && *(p + 2)) {
+          if(pass) {
+            bp_image_write16(image + c[1], read_id(p + 1));
+            bp_image_write32(image + c[1] + 2, next_code(p + 1) - program);
+            c[1] += BP_IMAGE_LABEL_SIZE;
+          } else n[1]++;
+        } else if(
+          *p == BP_IF || *p == BP_ELSE || *p == BP_FOR || *p == BP_WHILE
+        ) {
+          if((m = block_match(p)) == NULL) continue;
+          if(pass) {
+            bp_image_write32(image + c[2], a);
+            bp_image_write32(image + c[2] + 4, m - program);
+            c[2] += BP_IMAGE_BLOCK_SIZE;
+          } else n[2]++;
+        } else if(*p >= '0' && *p <= '9') {
+          if(pass) {
+            int64_t v = 0;
+            for(m = p; *m >= '0' && *m <= '9'; m++) v = (v * 10) + (*m - '0');
+            bp_image_write32(image + c[3], a);
+            bp_image_write64(image + c[3] + 4, v);
+            c[3] += BP_IMAGE_CONSTANT_SIZE;
+          } else n[3]++;
+        } else if(*p == BP_STRING) {
+          m = next_code(p);
+          if(*(m - 1) != BP_STRING) continue;
+          if(pass) {
+            bp_image_write32(image + c[4], a);
+            a = (m - p) - 2;
+            bp_image_write16(image + c[4] + 4, (a > 0xFFFF) ? 0xFFFF : a);
+            c[4] += BP_IMAGE_STRING_SIZE;
+          } else n[4]++;
+        }
+      }
+    }
+    image[0] = 'B';
+    image[1] = 'I';
+    image[2] = 'P';
+    image[3] = BP_IMAGE_VERSION;
+    bp_image_write32(image + 4, body + length + 1);
+    bp_image_write32(image + 8, body);
+    bp_image_write32(image + 12, length);
+    bp_image_write16(image + 16, requirements.variables);
+    bp_image_write16(image + 18, requirements.strings);
+    bp_image_write16(image + 20, requirements.functions);
+    bp_image_write16(image + 22, 0);
+    for(uint8_t t = 0; t < 5; t++) bp_image_write32(image + 24 + (t * 4), n[t]);
+    memcpy(image + body, program, length + 1);
+    return body + length + 1;
   };
 
   /* RUN COMPILATION ------------------------------------------------------ */
   void run(char *program) {
+    reset_string_scan();
+    symbols_length = 0;
+    if(symbols && symbols_size) symbols[0] = 0;
     // Initial program consistency checks
     if(!check_delimeter(program, BP_L_RPARENT, BP_R_RPARENT)) {
       error(0, BP_ERROR_ROUND_PARENTHESIS);
@@ -298,6 +731,8 @@ public:
     encode_char(program, BP_VAR_ACCESS_HUMAN, BP_VAR_ACCESS);
     // Memory reference access
     encode_char(program, BP_MEM_ACCESS_HUMAN, BP_MEM_ACCESS);
+    // Typed memory views
+    encode_mem_views(program);
     // Encode variables
     encode_variables(program, false);
     encode_variables(program, true);
@@ -319,9 +754,17 @@ public:
     // Bitwise not
     encode_char(program, BP_BITWISE_NOT_HUMAN, BP_BITWISE_NOT);
     // Minify functions
-    for(uint8_t i = 0; i < BP_MAX_FUNCTIONS; i++)
-      encode_functions(program);
+    encode_natives(program);
+    encode_functions(program);
     // System calls
+    encode_char(program, BP_ABURST_HUMAN, BP_ABURST);
+    encode_char(program, BP_PINS_WRITE_HUMAN, BP_PINS_WRITE);
+    encode_char(program, BP_PINS_READ_HUMAN, BP_PINS_READ);
+    encode_char(program, BP_SHIFT_OUT_HUMAN, BP_SHIFT_OUT);
+    encode_char(program, BP_STRFIND_HUMAN, BP_STRFIND);
+    encode_char(program, BP_STRCMP_HUMAN, BP_STRCMP);
+    encode_char(program, BP_STRCAT_HUMAN, BP_STRCAT);
+    encode_char(program, BP_SUBSTR_HUMAN, BP_SUBSTR);
     encode_char(program, BP_AGET_HUMAN, BP_AGET);
     encode_char(program, BP_DWRITE_HUMAN, BP_DWRITE);
     encode_char(program, BP_DREAD_HUMAN, BP_DREAD);
@@ -330,9 +773,19 @@ public:
     encode_char(program, BP_MILLIS_HUMAN, BP_MILLIS);
     encode_char(program, BP_DELAY_HUMAN, BP_DELAY);
     encode_char(program, BP_SQRT_HUMAN, BP_SQRT);
+    encode_char(program, BP_MEMMINMAX_HUMAN, BP_MEMMINMAX);
+    encode_char(program, BP_MEMSCALE_HUMAN, BP_MEMSCALE);
+    encode_char(program, BP_MEMFILL_HUMAN, BP_MEMFILL);
+    encode_char(program, BP_MEMCOPY_HUMAN, BP_MEMCOPY);
+    encode_char(program, BP_MEMSUM_HUMAN, BP_MEMSUM);
+    encode_char(program, BP_MEMDOT_HUMAN, BP_MEMDOT);
+    encode_char(program, BP_TRYRECV_HUMAN, BP_TRYRECV);
+    encode_char(program, BP_RECV_HUMAN, BP_RECV);
+    encode_char(program, BP_SEND_HUMAN, BP_SEND);
     // Language syntax
     encode_char(program, BP_SERIAL_RX_HUMAN, BP_SERIAL_RX);
     encode_char(program, BP_SERIAL_TX_HUMAN, BP_SERIAL_TX);
+    encode_char(program, BP_SERIAL_HUMAN, BP_SERIAL);
     encode_char(program, BP_CONTINUE_HUMAN, BP_CONTINUE);
     encode_char(program, BP_RESTART_HUMAN, BP_RESTART);
     encode_char(program, BP_NUMERIC_HUMAN, BP_NUMERIC);
@@ -340,6 +793,7 @@ public:
     encode_char(program, BP_ATOL_HUMAN, BP_ATOL);
     encode_char(program, BP_INPUT_HUMAN, BP_INPUT);
     encode_char(program, BP_BREAK_HUMAN, BP_BREAK);
+    encode_char(program, BP_PRINTF_HUMAN, BP_PRINTF);
     encode_char(program, BP_PRINT_HUMAN, BP_PRINT);
     encode_char(program, BP_WHILE_HUMAN, BP_WHILE);
     encode_char(program, BP_ENDIF_HUMAN, BP_ENDIF);
@@ -353,6 +807,10 @@ public:
     encode_char(program, BP_END_HUMAN, BP_END);
     encode_char(program, BP_FOR_HUMAN, BP_FOR);
     encode_char(program, BP_IF_HUMAN, BP_IF);
+    encode_char(program, BP_PIN_HUMAN, BP_PIN);
+    encode_char(program, BP_EVERY_HUMAN, BP_EVERY);
+    encode_char(program, BP_ON_HUMAN, BP_ON);
+    encode_char(program, "call", BP_COMMA);
     encode_char(program, "to", BP_COMMA);
     encode_char(program, "step", BP_COMMA);
     encode(program, "not", "1-");
@@ -365,22 +823,40 @@ public:
     encode(program, "true", "1");
     encode(program, "LF", "10");
     encode(program, "CR", "13");
+    // Translate one byte ids
+    encode_ids(program);
     // Remove spaces
     remove_spaces(program);
     remove_cr(program);
-    // End compilation program consistency checks
-    if(!check_delimeter(program, BP_IF, BP_ENDIF))
-      error(0, BP_ERROR_BLOCK);
+    // Compile printf formats
+    encode_formats(program);
+    // End compilation program consistency checks (ids may look like codes)
+    int32_t blocks = 0;
+    for(char *p = program; *p; p = next_code(p))
+      blocks += (*p == BP_IF) - (*p == BP_ENDIF);
+    if(blocks) error(0, BP_ERROR_BLOCK);
     // Check variables, strings and functions buffer bounds
-    if((fun_id - BP_OFFSET) >= BP_MAX_FUNCTIONS)
+    if(
+      (fun_ids.count() > BP_MAX_FUNCTIONS) || (fun_ids.count() > BP_MAX_IDS)
+    ) {
       error(0, BP_ERROR_FUNCTION_MAX);
-    if((string_id - BP_OFFSET) >= BP_STRINGS)
+      fail = true;
+    }
+    if(
+      (string_ids.count() > BP_STRINGS) || (string_ids.count() > BP_MAX_IDS)
+    ) {
       error(0, BP_ERROR_STRING_MAX);
-    if((var_id - BP_OFFSET) >= BP_VARIABLES)
+      fail = true;
+    }
+    if(
+      (var_ids.count() > BP_VARIABLES) || (var_ids.count() > BP_MAX_IDS)
+    ) {
       error(0, BP_ERROR_VARIABLE_MAX);
+      fail = true;
+    }
+    // Compute the resources the program requires at run time
+    if(!fail) compute_requirements(program);
     // Reset indexes
-    var_id = BP_OFFSET;
-    string_id = BP_OFFSET;
-    fun_id = BP_OFFSET;
+    var_ids = string_ids = fun_ids = ids_t();
   };
 };
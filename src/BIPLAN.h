@@ -30,18 +30,28 @@
 #pragma once
 #include "BIPLAN_Defines.h"
 #include "BIPLAN_Decoder.h"
+#include "BIPLAN_Container.h"
+#include "BIPLAN_Memory.h"
+#include "BIPLAN_Number.h"
+#include "BIPLAN_Channel.h"
 
 class BIPLAN_Interpreter {
   public:
   /* TYPES ----------------------------------------------------------------- */
-  struct param_t { BP_VAR_TYPE value; uint8_t id = BP_VARIABLES; };
-  struct fun_t { char *address; uint8_t cycle_id; param_t params[BP_PARAMS]; };
-  struct def_t { char *address; uint16_t params[BP_PARAMS]; };
+  struct param_t { BP_VAR_TYPE value; uint16_t id = BP_VARIABLES; };
+  struct fun_t {
+    bp_code_t address;
+    uint8_t cycle_id;
+    param_t params[BP_PARAMS];
+  };
+  struct def_t { bp_code_t address; uint16_t params[BP_PARAMS]; };
+  struct table_t { bp_image_t data = 0; uint32_t length = 0; };
 
   struct cycle_type {
-    char *address;
+    bp_code_t address;
+    bp_code_t end = 0;
     BP_VAR_TYPE var = 0;
-    uint8_t var_id = BP_VARIABLES;
+    uint16_t var_id = BP_VARIABLES;
     BP_VAR_TYPE step = 0;
     BP_VAR_TYPE to = 0;
   };
@@ -50,66 +60,482 @@ class BIPLAN_Interpreter {
   BP_VAR_TYPE       variables      [BP_VARIABLES];
   uint8_t           memory         [BP_MEM_SIZE];
   char              string         [BP_STRING_MAX_LENGTH];
+#ifdef BP_STRING_ARENA
+  char              string_arena   [BP_STRING_ARENA];
+  uint16_t          string_offsets [BP_STRINGS];
+  uint16_t          string_sizes   [BP_STRINGS];
+  uint16_t          string_lengths [BP_STRINGS];
+  uint16_t          string_used    = 0;
+#else
   char              strings        [BP_STRINGS][BP_STRING_MAX_LENGTH];
+#endif
+#ifdef BP_MEM_REGIONS
+  bp_mem_region_t   regions        [BP_MEM_REGIONS] = {};
+#endif
+#ifdef BP_CHANNELS
+  bp_channel_t     *channels       [BP_CHANNELS] = {};
+#endif
+#ifdef BP_EVENTS
+  bp_event_t        events         [BP_EVENTS];
+  volatile bool     event_signaled = false;
+  bool              event_polled   = false;
+#endif
+#ifdef BP_TIMERS
+  bp_timer_t        timers         [BP_TIMERS];
+  uint8_t           timer_order    [BP_TIMERS]; // Slots by deadline
+  uint8_t           timer_count    = 0;
+#endif
+#if defined(BP_EVENTS) || defined(BP_TIMERS)
+  bool              handling       = false; // Running a handler
+#endif
+#ifdef BP_PRINT_BUFFER
+  char              print_buffer   [BP_PRINT_BUFFER + 1];
+  uint16_t          print_length   = 0;
+#endif
   struct cycle_type cycles         [BP_CYCLE_DEPTH];
   struct fun_t      functions      [BP_FUN_DEPTH];
   struct def_t      definitions    [BP_MAX_FUNCTIONS];
+  /* CONTAINER INDEXES (used in place) ------------------------------------ */
+  table_t           blocks;
+  table_t           constants;
+  table_t           literals;
   /* STATE ----------------------------------------------------------------- */
-  char             *program_start  = NULL;
+  bp_code_t         program_start  = 0;
+  bp_code_t         program_end    = 0;
   uint8_t           cycle_id       = 0;
   uint8_t           fun_cycle_id   = 0;
   int               fun_id         = 0;
   bool              ended          = false;
+  bool              waiting        = false; // On a channel (see send_call)
   uint8_t           return_type    = 0;
+  uint32_t          random_state   = BP_RANDOM_SEED;
+  bp_decoder_state_t decoder_state;
+#ifdef BP_PAGED
+  bp_pager_t        pager; // Page cache of the program (see bp_pager_init)
+#endif
   /* CALLBACKS ------------------------------------------------------------- */
   error_type        error_fun      = NULL;
-  BPM_PRINT_TYPE    print_fun      = NULL;
-  BPM_INPUT_TYPE    data_in_fun    = NULL;
-  BPM_SERIAL_TYPE   serial_fun     = NULL;
+  BPM_PRINT_TYPE    print_fun      = {};
+  BPM_INPUT_TYPE    data_in_fun    = {};
+  BPM_SERIAL_TYPE   serial_fun     = {};
+  const bp_native_t *natives       = NULL; // Same table passed to BCC
+  uint16_t          native_count   = 0;
+  const char       *symbols        = NULL; // Exported by BCC (see symbol)
+
+  /* HOST ACCESS BY NAME -------------------------------------------------
+     Names ("$name" or ":name") are looked up in the table exported by BCC
+     once, the handle returned is then used without any lookup: a pointer
+     to the variable or the id of the string for get_string and set_string.
+     NULL or BP_STRINGS are returned if the name is not found. */
+  uint16_t symbol(const char *name) {
+    for(const char *p = symbols; p && *p; p += strlen(p) + 3)
+      if(!strcmp(p, name)) {
+        const uint8_t *id = (const uint8_t *)p + strlen(p) + 1;
+        return id[0] | (id[1] << 8);
+      }
+    return BP_MAX_IDS;
+  };
+
+  BP_VAR_TYPE *variable_handle(const char *name) {
+    uint16_t id = (*name == BP_ADDRESS) ? symbol(name) : BP_VARIABLES;
+    return (id < BP_VARIABLES) ? &variables[id] : NULL;
+  };
+
+  uint16_t string_handle(const char *name) {
+    uint16_t id = (*name == BP_S_ADDRESS) ? symbol(name) : BP_STRINGS;
+    return (id < BP_STRINGS) ? id : BP_STRINGS;
+  };
+
+#ifdef BP_MEM_REGIONS
+  /* HOST MAPPED MEMORY --------------------------------------------------
+     Maps length bytes at data to @[address] and following, the region
+     overlays memory where they overlap. If fence is true BPM_MEM_FENCE is
+     executed before the program reads and after it writes the region,
+     notify (if not NULL) is called after each write. Length 0 unmaps. */
+  bool map_memory(
+    uint8_t r,
+    uint32_t address,
+    uint8_t *data,
+    uint32_t length,
+    bp_mem_notify_t notify = NULL,
+    bool fence = false
+  ) {
+    if(r >= BP_MEM_REGIONS) return false;
+    bp_mem_region_t m = {data, address, length, notify, fence};
+    if(!length) m.data = NULL;
+    regions[r] = m;
+    return true;
+  };
+
+  /* Region holding the b bytes at address a, BP_MEM_REGIONS if none */
+  uint8_t mem_region_at(BP_VAR_TYPE a, uint8_t b) {
+    if((a < 0) || ((uint64_t)a > 0xFFFFFFFF)) return BP_MEM_REGIONS;
+    for(uint8_t r = 0; r < BP_MEM_REGIONS; r++)
+      if(
+        regions[r].data && ((uint32_t)a >= regions[r].address) &&
+        (((uint64_t)a - regions[r].address + b) <= regions[r].length)
+      ) return r;
+    return BP_MEM_REGIONS;
+  };
+
+  /* Region holding the byte at p, BP_MEM_REGIONS if none */
+  uint8_t mem_region_of(const uint8_t *p) {
+    for(uint8_t r = 0; r < BP_MEM_REGIONS; r++)
+      if(
+        regions[r].data && (p >= regions[r].data) &&
+        (p < (regions[r].data + regions[r].length))
+      ) return r;
+    return BP_MEM_REGIONS;
+  };
+
+  /* The program wrote n elements of v */
+  void mem_written(const bp_mem_view_t &v, uint32_t n) {
+    uint8_t r = mem_region_of(v.data);
+    if(r == BP_MEM_REGIONS) return;
+    if(regions[r].fence) BPM_MEM_FENCE();
+    if(regions[r].notify)
+      regions[r].notify(r, v.data - regions[r].data, n * v.bytes);
+  };
+#else
+  void mem_written(const bp_mem_view_t &, uint32_t) { };
+#endif
+
+#ifdef BP_CHANNELS
+  /* CHANNELS ------------------------------------------------------------
+     Attaches c as channel id, NULL detaches it. The same channel can be
+     attached to more interpreters, any of them may send, only one may
+     receive. */
+  bool attach_channel(uint8_t id, bp_channel_t *c) {
+    if(id >= BP_CHANNELS) return false;
+    channels[id] = c;
+    return true;
+  };
+
+  bp_channel_t *channel(BP_VAR_TYPE id) {
+    return ((id >= 0) && (id < BP_CHANNELS)) ? channels[id] : NULL;
+  };
+#else
+  bp_channel_t *channel(BP_VAR_TYPE) { return NULL; };
+#endif
+
+  /* USE THE DECODER STATE AND THE PAGER OF THIS INTERPRETER ------------ */
+  void decoder_own() {
+    bp_decoder = &decoder_state;
+    #ifdef BP_PAGED
+      bp_pager = &pager;
+    #endif
+  };
+
+#ifdef BP_EVENTS
+  /* EVENTS --------------------------------------------------------------
+     on pin and on serial register a handler in a free slot (or in the one
+     of the same source) and arm the source with BPM_EVENT_PIN or
+     BPM_EVENT_SERIAL. Pending events are handled before the next
+     statement (see handlers_dispatch), each handler runs to its return.
+     Pin handlers receive the pin number if they have a parameter. */
+  bool attach_event(uint8_t type, BP_VAR_TYPE source, uint16_t f) {
+    uint8_t slot = BP_EVENTS;
+    for(uint8_t i = BP_EVENTS; i; i--) {
+      bp_event_t &e = events[i - 1];
+      if(!e.type) slot = i - 1;
+      else if((e.type == type) && (e.source == source)) {
+        e.fun = f;
+        return true;
+      }
+    }
+    if(slot == BP_EVENTS) return false;
+    bp_event_t &e = events[slot];
+    bp_event_take(e.pending);
+    e.type = type;
+    e.source = source;
+    e.fun = f;
+    if(type == BP_EVENT_PIN) {
+      e.polled = !BPM_EVENT_PIN(&e, source);
+      e.last = BPM_IO_READ(source);
+    } else e.polled = !BPM_EVENT_SERIAL(&e, serial_fun);
+    event_polled = event_polled || e.polled;
+    return true;
+  };
+
+  void events_dispatch() {
+    for(uint8_t i = 0; (i < BP_EVENTS) && !ended; i++) {
+      bp_event_t &e = events[i];
+      if(!e.type) continue;
+      if(e.polled) {
+        if(e.type == BP_EVENT_SERIAL) {
+          if(BPM_SERIAL_AVAILABLE(serial_fun) > 0) bp_event_set(e.pending);
+        } else if(BPM_IO_READ(e.source) != e.last) {
+          e.last = BPM_IO_READ(e.source);
+          bp_event_set(e.pending);
+        }
+      }
+      if(!bp_event_take(e.pending)) continue;
+      event_call(e.fun, e.source);
+      // Armed sources signal new data only, the rest calls the handler again
+      if(
+        !e.polled && !ended && (e.type == BP_EVENT_SERIAL) &&
+        (BPM_SERIAL_AVAILABLE(serial_fun) > 0)
+      ) bp_event_signal(&e);
+    }
+  };
+
+  void events_reset() {
+    for(uint8_t i = 0; i < BP_EVENTS; i++) {
+      events[i].type = 0; // Sources armed before signal it in vain
+      if(events[i].signaled != &event_signaled)
+        events[i].signaled = &event_signaled;
+    }
+    bp_event_take(event_signaled);
+    event_polled = false;
+  };
+#else
+  bool attach_event(uint8_t, BP_VAR_TYPE, uint16_t) { return false; };
+  void events_reset() { };
+#endif
+
+#ifdef BP_TIMERS
+  /* TIMERS --------------------------------------------------------------
+     every registers a periodic call in a free slot (or in the one of the
+     same function, period 0 frees it). timer_order keeps the slots in use
+     sorted by deadline, before each statement only the first deadline is
+     compared with the time and a single due call is executed. Deadlines
+     advance by the period, not from the time of the call, so calls do
+     not drift, periods entirely missed are skipped and counted. The host
+     can read the statistics of each slot in timers. */
+  uint8_t timer_unlink(uint8_t o) {
+    uint8_t slot = timer_order[o];
+    // Also bound by BP_TIMERS, so that the compiler sees the indexes fit
+    for(timer_count--; (o < timer_count) && ((o + 1) < BP_TIMERS); o++)
+      timer_order[o] = timer_order[o + 1];
+    return slot;
+  };
+
+  void timer_link(uint8_t slot) {
+    uint8_t o = timer_count++;
+    if(o >= BP_TIMERS) return; // Not reached, slot was free
+    for(; o; o--) {
+      if((int32_t)(timers[slot].next - timers[timer_order[o - 1]].next) >= 0)
+        break;
+      timer_order[o] = timer_order[o - 1];
+    }
+    timer_order[o] = slot;
+  };
+
+  bool attach_timer(uint32_t period, uint16_t f) {
+    uint8_t slot = BP_TIMERS;
+    for(uint8_t o = 0; (o < timer_count) && (slot == BP_TIMERS); o++)
+      if(timers[timer_order[o]].fun == f) slot = timer_unlink(o);
+    if(slot == BP_TIMERS) {
+      for(uint8_t i = BP_TIMERS; i; i--)
+        if(!timers[i - 1].period) slot = i - 1;
+      if(slot == BP_TIMERS) return !period;
+      timers[slot] = bp_timer_t();
+    }
+    if(!(timers[slot].period = period)) return true;
+    timers[slot].fun = f;
+    timers[slot].next = BPM_MILLIS() + period;
+    timer_link(slot);
+    return true;
+  };
+
+  void timers_dispatch() {
+    uint8_t slot = timer_order[0];
+    bp_timer_t &t = timers[slot];
+    uint32_t late = BPM_MILLIS() - t.next;
+    if((int32_t)late < 0) return;
+    timer_unlink(0);
+    t.runs++;
+    t.jitter_sum += late;
+    if(late > t.jitter_max) t.jitter_max = late;
+    t.overruns += late / t.period;
+    t.next += ((late / t.period) + 1) * t.period;
+    timer_link(slot);
+    event_call(t.fun, late);
+  };
+
+  void timers_reset() {
+    for(uint8_t i = 0; i < BP_TIMERS; i++) timers[i] = bp_timer_t();
+    timer_count = 0;
+  };
+#else
+  bool attach_timer(uint32_t, uint16_t) { return false; };
+  void timers_reset() { };
+#endif
+
+  /* HANDLERS - Events and timers due, called before each statement ------
+     Also within functions and loops, handlers are not interrupted by
+     other handlers. */
+  void handlers_dispatch() {
+  #if defined(BP_EVENTS) || defined(BP_TIMERS)
+    if(handling) return;
+    handling = true;
+    #ifdef BP_EVENTS
+      if(bp_event_take(event_signaled) || event_polled) events_dispatch();
+    #endif
+    #ifdef BP_TIMERS
+      if(timer_count && !ended) timers_dispatch();
+    #endif
+    handling = false;
+  #endif
+  };
 
   /* FINISHED -------------------------------------------------------------- */
-  bool finished() { return ended || decoder_finished(); };
+  bool finished() { decoder_own(); return ended || decoder_finished(); };
 
   /* RUN ------------------------------------------------------------------- */
-  bool run() { statement(); return !ended;  };
+  bool run() {
+    decoder_own();
+    waiting = false;
+    statement();
+    if(finished()) print_flush();
+    return !ended;
+  };
 
   /* END PROGRAM ----------------------------------------------------------- */
   void end_call() { expect(BP_END); ended = true; };
 
   /* RESTART PROGRAM CALL -------------------------------------------------- */
-  void restart_call() { set_default(); decoder_init(program_start); };
+  void restart_call() {
+    print_flush();
+    set_default();
+    decoder_init(program_start);
+  };
 
   /* ERROR ----------------------------------------------------------------- */
-  void error(char *position, const char *string) {
-    error_fun(position, string);
+  void error(bp_code_t position, const char *string) {
+    print_flush();
+    error_fun(error_position(position), string);
     ended = true;
   };
 
-  /* INDEX LINES ----------------------------------------------------------- */
-  void index_function_definitions(char* program) {
-    char *p = program;
+  /* Paged programs are not in memory, the callback receives NULL */
+  char *error_position(bp_code_t position) {
+  #ifdef BP_PAGED
+    (void)position;
+    return NULL;
+  #else
+    return (char *)position;
+  #endif
+  };
+
+  /* INDEX FUNCTION DEFINITIONS ------------------------------------------- */
+  void index_function_definitions(bp_code_t program) {
+    bp_code_t p;
     uint16_t param, l = 0;
-    for(; *p && p; p++) {
-      if(*p == BP_FUN_DEF) {
-        param = 0;
-        p++; l = *p - BP_OFFSET;
-        for(uint8_t i = 0; i < BP_PARAMS; i++)
-          definitions[l].params[i] = BP_PARAMS;
+    for(uint16_t i = 0; i < BP_MAX_FUNCTIONS; i++)
+      definitions[i].address = 0;
+    decoder_init(program);
+    while(decoder_get() != BP_ENDOFINPUT) {
+      p = decoder_position();
+      // Invalid function ids are reported by verify
+      if(
+        (decoder_get() != BP_FUN_DEF) ||
+        ((l = decoder_id(p)) >= BP_MAX_FUNCTIONS)
+      ) {
+        decoder_next();
+        continue;
+      }
+      param = 0;
+      for(uint8_t i = 0; i < BP_PARAMS; i++)
+        definitions[l].params[i] = BP_VARIABLES;
+      p = decoder_skip_id(p);
+      while(decoder_read(p) == BP_COMMA || decoder_read(p) == BP_L_RPARENT) {
         p++;
-        while(*p == BP_COMMA || *p == BP_L_RPARENT) {
-          p++;
-          if(*p == BP_ADDRESS) {
-            p++;
-            definitions[l].params[param++] = *p;
-            p++;
-          } if(*p == BP_R_RPARENT) break;
-        } definitions[l].address = p + 1;
+        if(decoder_read(p) == BP_ADDRESS) {
+          if(param >= BP_PARAMS) error(p + 1, BP_ERROR_PARAMETERS);
+          else definitions[l].params[param++] = decoder_id(p);
+          p = decoder_skip_id(p);
+        } if(decoder_read(p) == BP_R_RPARENT) break;
+      } definitions[l].address = p + 1;
+      decoder_goto(p + 1);
+    }
+  };
+
+  /* COUNT THE ARGUMENTS OF A CALL ---------------------------------------- */
+  uint16_t count_arguments() {
+    uint16_t depth = 0, arguments = 1;
+    if(decoder_get() != BP_L_RPARENT) return 0;
+    decoder_next();
+    if(decoder_get() == BP_R_RPARENT) return 0;
+    while(decoder_get() != BP_ENDOFINPUT) {
+      if(decoder_get() == BP_L_RPARENT) depth++;
+      if(decoder_get() == BP_R_RPARENT) {
+        if(!depth) break;
+        depth--;
+      }
+      if((decoder_get() == BP_COMMA) && !depth) arguments++;
+      decoder_next();
+    } return arguments;
+  };
+
+  /* VERIFY PROGRAM (ids, block nesting and call arity) ------------------- */
+  bool verify(bp_code_t program) {
+    uint32_t blocks = 0, nesting = 0;
+    uint16_t id, params;
+    bp_code_t p;
+    decoder_init(program);
+    while(!ended && (decoder_get() != BP_ENDOFINPUT)) {
+      p = decoder_position();
+      id = decoder_id(p);
+      switch(decoder_get()) {
+        case BP_ERROR: error(p, BP_ERROR_SYMBOL); break;
+        case BP_ADDRESS:
+          if(id >= BP_VARIABLES) error(p, BP_ERROR_VARIABLE_GET);
+          break;
+        case BP_S_ADDRESS:
+          if(id >= BP_STRINGS) error(p, BP_ERROR_STRING_GET);
+          break;
+        case BP_LABEL:
+          if(decoder_read(p + 1) != BP_ADDRESS) error(p, BP_ERROR_SYMBOL);
+          break;
+        case BP_PRINTF:
+          if(decoder_read(p + 1) != BP_STRING) error(p, BP_ERROR_FORMAT);
+          break;
+        case BP_FUN_DEF:
+          if(blocks) error(p, BP_ERROR_BLOCK);
+          if(nesting) error(p, BP_ERROR_CYCLE_NEXT);
+          if(id >= BP_MAX_FUNCTIONS) error(p, BP_ERROR_FUNCTION_MAX);
+          break;
+        case BP_FUNCTION:
+          if((id >= BP_MAX_FUNCTIONS) || !definitions[id].address) {
+            error(p, BP_ERROR_FUNCTION_DEFINITION);
+            break;
+          }
+          for(params = 0; params < BP_PARAMS; params++)
+            if(definitions[id].params[params] == BP_VARIABLES) break;
+          decoder_next();
+          if(count_arguments() > params) error(p, BP_ERROR_PARAMETERS);
+          decoder_goto(p);
+          break;
+        case BP_NATIVE:
+          if(id >= native_count) {
+            error(p, BP_ERROR_NATIVE);
+            break;
+          }
+          decoder_next();
+          if(
+            (decoder_get() != BP_L_RPARENT) ||
+            (natives[id].params > BP_PARAMS) ||
+            (count_arguments() != natives[id].params)
+          ) error(p, BP_ERROR_NATIVE_CALL);
+          decoder_goto(p);
+          break;
+        case BP_IF: blocks++; break;
+        case BP_ENDIF: if(!blocks--) error(p, BP_ERROR_BLOCK); break;
+        case BP_FOR: ;
+        case BP_WHILE:
+          if(++nesting > BP_CYCLE_DEPTH) error(p, BP_ERROR_CYCLE_MAX);
+          break;
+        case BP_NEXT: if(!nesting--) error(p, BP_ERROR_CYCLE_NEXT); break;
       } decoder_next();
     }
+    if(blocks) error(decoder_position(), BP_ERROR_BLOCK);
+    if(nesting) error(decoder_position(), BP_ERROR_CYCLE_NEXT);
+    return !ended;
   };
 
   /* PROCESS LABEL STATEMENTS --------------------------------------------- */
-  void process_labels(char* program) {
+  void process_labels(bp_code_t program) {
     decoder_init(program);
     while(decoder_get() != BP_ENDOFINPUT) {
       if(decoder_get() == BP_LABEL) statement();
@@ -121,32 +547,208 @@ class BIPLAN_Interpreter {
 
   BIPLAN_Interpreter() { set_default(); };
 
+  ~BIPLAN_Interpreter() {
+    if(bp_decoder == &decoder_state) bp_decoder = &bp_decoder_default;
+    #ifdef BP_PAGED
+      if(bp_pager == &pager) bp_pager = NULL;
+    #endif
+  };
+
   void initialize(
-    char *program,
+    bp_code_t program,
     error_type error,
     BPM_PRINT_TYPE print,
     BPM_INPUT_TYPE data_input,
     BPM_SERIAL_TYPE s
   ) {
+    decoder_own();
+    blocks = constants = literals = table_t();
     program_start = program;
+    for(program_end = program; decoder_read(program_end); program_end++);
+    serial_fun = s;
+    error_fun = error;
+    print_fun = print;
+    data_in_fun = data_input;
     set_default();
     index_function_definitions(program);
-    process_labels(program);
+    if(verify(program)) process_labels(program);
     decoder_init(program);
+  };
+
+  /* LOAD A BIP CONTAINER (see BIPLAN_Container.h) ------------------------ */
+  bool load(
+    bp_image_t image,
+    uint32_t size,
+    error_type error,
+    BPM_PRINT_TYPE print,
+    BPM_INPUT_TYPE data_input,
+    BPM_SERIAL_TYPE s
+  ) {
+    bp_image_t p = image + BP_IMAGE_HEADER, end;
+    uint32_t length, body, code, n[5];
+    uint16_t id;
+    uint8_t params;
+    decoder_own();
     serial_fun = s;
     error_fun = error;
     print_fun = print;
     data_in_fun = data_input;
+    blocks = constants = literals = table_t();
+    set_default();
+    for(uint16_t i = 0; i < BP_MAX_FUNCTIONS; i++)
+      definitions[i].address = 0;
+    if(
+      (size < BP_IMAGE_HEADER) || (bp_image_read8(image) != 'B') ||
+      (bp_image_read8(image + 1) != 'I') || (bp_image_read8(image + 2) != 'P') ||
+      (bp_image_read8(image + 3) != BP_IMAGE_VERSION) ||
+      ((length = bp_image_read32(image + 4)) > size) ||
+      ((body = bp_image_read32(image + 8)) >= length) ||
+      (body < BP_IMAGE_HEADER) ||
+      ((code = bp_image_read32(image + 12)) != (length - body - 1)) ||
+      bp_image_read8(image + length - 1) ||
+      (bp_image_read16(image + 16) > BP_VARIABLES) ||
+      (bp_image_read16(image + 18) > BP_STRINGS) ||
+      (bp_image_read16(image + 20) > BP_MAX_FUNCTIONS)
+    ) return load_error();
+    end = image + body;
+    program_start = (bp_code_t)end;
+    program_end = program_start + code;
+    for(uint8_t t = 0; t < 5; t++) n[t] = bp_image_read32(image + 24 + (t * 4));
+    // Function definitions
+    for(uint32_t i = 0; i < n[0]; i++, p += 7 + (params * 2)) {
+      if(((p + 7) > end)) return load_error();
+      params = bp_image_read8(p + 6);
+      if(
+        ((p + 7 + (params * 2)) > end) ||
+        ((id = bp_image_read16(p)) >= BP_MAX_FUNCTIONS) ||
+        (params > BP_PARAMS) || (bp_image_read32(p + 2) > code)
+      ) return load_error();
+      definitions[id].address = program_start + bp_image_read32(p + 2);
+      for(uint8_t j = 0; j < BP_PARAMS; j++) {
+        definitions[id].params[j] = BP_VARIABLES;
+        if(j >= params) continue;
+        uint16_t param = bp_image_read16(p + 7 + (j * 2));
+        if(param >= BP_VARIABLES) return load_error();
+        definitions[id].params[j] = param;
+      }
+    }
+    // Labels
+    for(uint32_t i = 0; i < n[1]; i++, p += BP_IMAGE_LABEL_SIZE) {
+      if(
+        ((p + BP_IMAGE_LABEL_SIZE) > end) ||
+        ((id = bp_image_read16(p)) >= BP_VARIABLES) ||
+        (bp_image_read32(p + 2) > code)
+      ) return load_error();
+      variables[id] = bp_image_read32(p + 2);
+    }
+    // Blocks, constants and string literals
+    if(
+      !(p = load_table(blocks, p, end, n[2], BP_IMAGE_BLOCK_SIZE, code)) ||
+      !(p = load_table(constants, p, end, n[3], BP_IMAGE_CONSTANT_SIZE, code))||
+      !(p = load_table(literals, p, end, n[4], BP_IMAGE_STRING_SIZE, code)) ||
+      (p != end)
+    ) return load_error();
+    // The body may be corrupt or crafted, its ids are verified as in text
+    if(!verify(program_start)) return false;
+    decoder_init(program_start);
+    return true;
+  };
+
+  bp_image_t load_table(
+    table_t &t,
+    bp_image_t p,
+    bp_image_t end,
+    uint32_t entries,
+    uint8_t entry_size,
+    uint32_t code
+  ) {
+    if(((uint64_t)entries * entry_size) > (uint64_t)(end - p)) return 0;
+    for(uint32_t i = 0; i < entries; i++) {
+      bp_image_t e = p + (i * entry_size);
+      if(bp_image_read32(e) >= code) return 0;
+      if(
+        (entry_size == BP_IMAGE_BLOCK_SIZE) && (bp_image_read32(e + 4) > code)
+      ) return 0;
+      if(
+        (entry_size == BP_IMAGE_STRING_SIZE) &&
+        ((bp_image_read32(e) + bp_image_read16(e + 4) + 2) > code)
+      ) return 0;
+    }
+    t.data = p;
+    t.length = entries;
+    return p + (entries * entry_size);
+  };
+
+  bool load_error() {
+    error(0, BP_ERROR_IMAGE);
+    return false;
+  };
+
+  /* FIND THE MATCHING ADDRESS OF A BLOCK IN THE CONTAINER INDEX ---------- */
+  bp_code_t block_end(bp_code_t p) {
+    if(!p || !blocks.data) return 0;
+    bp_image_t e = bp_image_find(
+      blocks.data, blocks.length, BP_IMAGE_BLOCK_SIZE, p - program_start
+    );
+    return (e) ? program_start + bp_image_read32(e + 4) : 0;
+  };
+
+  /* NUMERIC LITERAL (read from the constant pool if available) ----------- */
+  BP_VAR_TYPE number() {
+    if(constants.data) {
+      bp_image_t e = bp_image_find(
+        constants.data,
+        constants.length,
+        BP_IMAGE_CONSTANT_SIZE,
+        decoder_position() - program_start
+      );
+      if(e) return (BP_VAR_TYPE)bp_image_read64(e + 4);
+    }
+    BP_UVAR_TYPE v = 0;
+    for(uint8_t i = 0; i < BP_NUM_MAX_LENGTH; i++) { // Program may be in flash
+      char c = decoder_read(decoder_position() + i);
+      if(c < '0' || c > '9') break;
+      v = (v * 10) + (uint8_t)(c - '0');
+    }
+    return (BP_VAR_TYPE)v;
+  };
+
+  /* STRING LITERAL (length read from the container if available) --------- */
+  void literal(char *d, uint16_t l) {
+    if(literals.data && (decoder_get() == BP_STRING)) {
+      bp_image_t e = bp_image_find(
+        literals.data,
+        literals.length,
+        BP_IMAGE_STRING_SIZE,
+        decoder_position() - program_start
+      );
+      if(e) {
+        uint16_t n = bp_image_read16(e + 4);
+        if(n >= l) n = l - 1;
+        for(uint16_t i = 0; i < n; i++)
+          d[i] = decoder_read(decoder_position() + 1 + i);
+        d[n] = 0;
+        return;
+      }
+    } decoder_string(d, l);
   };
 
   void set_default() {
+    events_reset();
+    timers_reset();
     cycle_id = 0;
     fun_id = 0;
     ended = false;
     for(BP_VAR_TYPE i = 0; i < BP_MEM_SIZE; i++) memory[i] = 0;
     for(BP_VAR_TYPE i = 0; i < BP_VARIABLES; i++) variables[i] = 0;
-    for(BP_VAR_TYPE i = 0; i < BP_STRINGS; i++)
-      for(BP_VAR_TYPE c = 0; c < BP_STRING_MAX_LENGTH; c++) strings[i][c] = 0;
+    #ifdef BP_STRING_ARENA
+      string_used = 0;
+      for(BP_VAR_TYPE i = 0; i < BP_STRINGS; i++)
+        string_offsets[i] = string_sizes[i] = string_lengths[i] = 0;
+    #else
+      for(BP_VAR_TYPE i = 0; i < BP_STRINGS; i++)
+        for(BP_VAR_TYPE c = 0; c < BP_STRING_MAX_LENGTH; c++) strings[i][c] = 0;
+    #endif
     for(BP_VAR_TYPE i = 0; i < BP_STRING_MAX_LENGTH; i++) string[i] = 0;
   };
 
@@ -162,17 +764,211 @@ class BIPLAN_Interpreter {
     return c;
   };
 
-  /* GET VARIABLE ---------------------------------------------------------- */
+  /* BOUND A DYNAMIC INDEX ------------------------------------------------- */
+  BP_VAR_TYPE bound(BP_VAR_TYPE i, BP_VAR_TYPE size, const char *e) {
+    if((i >= 0) && (i < size)) return i;
+    #ifndef BP_UNCHECKED
+      error(decoder_position(), e);
+    #else
+      (void)e; // Out of bound indexes are clamped without error
+    #endif
+    return (i < 0) ? 0 : size - 1;
+  };
+
+  /* GET VARIABLE (ids are checked by verify) ------------------------------ */
   BP_VAR_TYPE get_variable(int n) {
-    if(n >= 0 && n <= BP_VARIABLES) return variables[n];
-    error(decoder_position(), BP_ERROR_VARIABLE_GET);
-    return 0;
+    #ifndef BP_UNCHECKED
+      if(n < 0 || n >= BP_VARIABLES) {
+        error(decoder_position(), BP_ERROR_VARIABLE_GET);
+        return 0;
+      }
+    #endif
+    return variables[n];
   };
 
-  /* SET VARIABLE ---------------------------------------------------------- */
+  /* SET VARIABLE (ids are checked by verify) ------------------------------ */
   void set_variable(int n, BP_VAR_TYPE v) {
-    if(n >= 0 && n <= BP_VARIABLES) variables[n] = v;
-    else error(decoder_position(), BP_ERROR_VARIABLE_SET);
+    #ifndef BP_UNCHECKED
+      if(n < 0 || n >= BP_VARIABLES)
+        return error(decoder_position(), BP_ERROR_VARIABLE_SET);
+    #endif
+    variables[n] = v;
+  };
+
+  /* CHECK A STRING ID (ids are checked by verify) ------------------------- */
+  bool string_valid(uint16_t id, const char *e) {
+    #ifndef BP_UNCHECKED
+      if(id >= BP_STRINGS) {
+        error(decoder_position(), e);
+        return false;
+      }
+    #else
+      (void)id;
+      (void)e;
+    #endif
+    return true;
+  };
+
+  /* STRINGS (ids are checked by string_valid, indexes by the caller) ------ */
+#ifdef BP_STRING_ARENA
+  /* Strings are stored in the arena in id order, each with its size, the
+     last byte of a non-empty string is always 0. Growing a string moves the
+     following ones, if the arena is full the strings are compacted to their
+     length (characters set past the end of a string are lost). */
+  void compact_strings() {
+    uint16_t o = 0;
+    for(uint16_t i = 0; i < BP_STRINGS; i++) {
+      uint16_t size = string_sizes[i] ? string_lengths[i] + 1 : 0;
+      memmove(string_arena + o, string_arena + string_offsets[i], size);
+      string_offsets[i] = o;
+      string_sizes[i] = size;
+      o += size;
+    }
+    string_used = o;
+  };
+
+  bool reserve_string(uint16_t id, uint16_t size) {
+    if(size <= string_sizes[id]) return true;
+    size = ((size + BP_STRING_ARENA_STEP - 1) / BP_STRING_ARENA_STEP) *
+      BP_STRING_ARENA_STEP;
+    if(size > BP_STRING_MAX_LENGTH) size = BP_STRING_MAX_LENGTH;
+    if((string_used + size - string_sizes[id]) > BP_STRING_ARENA)
+      compact_strings();
+    uint16_t grow = size - string_sizes[id];
+    if((string_used + grow) > BP_STRING_ARENA) {
+      error(decoder_position(), BP_ERROR_STRING_ARENA);
+      return false;
+    }
+    uint16_t end = string_offsets[id] + string_sizes[id];
+    memmove(string_arena + end + grow, string_arena + end, string_used - end);
+    memset(string_arena + end, 0, grow);
+    for(uint16_t i = id + 1; i < BP_STRINGS; i++) string_offsets[i] += grow;
+    string_sizes[id] = size;
+    string_used += grow;
+    return true;
+  };
+
+  const char *get_string(uint16_t id) {
+    if(!string_valid(id, BP_ERROR_STRING_GET)) return "";
+    return string_sizes[id] ? string_arena + string_offsets[id] : "";
+  };
+
+  uint16_t string_length(uint16_t id) {
+    return string_valid(id, BP_ERROR_STRING_GET) ? string_lengths[id] : 0;
+  };
+
+  char get_string_char(uint16_t id, uint16_t i) {
+    if(!string_valid(id, BP_ERROR_STRING_GET)) return 0;
+    return (i < string_sizes[id]) ? string_arena[string_offsets[id] + i] : 0;
+  };
+
+  void set_string_char(uint16_t id, uint16_t i, char c) {
+    if(!string_valid(id, BP_ERROR_STRING_SET)) return;
+    if((i >= (BP_STRING_MAX_LENGTH - 1)) || (!c && (i >= string_sizes[id])))
+      return;
+    if(!reserve_string(id, i + 2)) return;
+    char *s = string_arena + string_offsets[id];
+    s[i] = c;
+    if(!c && (i < string_lengths[id])) string_lengths[id] = i;
+    else if(c && (i == string_lengths[id]))
+      while(s[string_lengths[id]]) string_lengths[id]++;
+  };
+
+  void set_string(uint16_t id, const char *s, uint16_t l) {
+    if(!string_valid(id, BP_ERROR_STRING_SET)) return;
+    if(!l && !string_sizes[id]) return;
+    if(!reserve_string(id, l + 1)) return;
+    memcpy(string_arena + string_offsets[id], s, l);
+    string_arena[string_offsets[id] + l] = 0;
+    string_lengths[id] = l;
+  };
+
+  void copy_string(uint16_t d, uint16_t s) {
+    if(
+      !string_valid(d, BP_ERROR_STRING_SET) ||
+      !string_valid(s, BP_ERROR_STRING_GET) || (d == s)
+    ) return;
+    uint16_t l = string_lengths[s];
+    if(!reserve_string(d, l + 1)) return; // May move s
+    set_string(d, get_string(s), l);
+  };
+
+  void literal_string(uint16_t id) {
+    literal(string, sizeof(string));
+    set_string(id, string, strlen(string));
+  };
+
+  // Room for size bytes (at most BP_STRING_MAX_LENGTH), may move strings
+  char *string_space(uint16_t id, uint16_t size) {
+    if(!string_valid(id, BP_ERROR_STRING_SET)) return NULL;
+    if(!reserve_string(id, size)) return NULL;
+    return string_arena + string_offsets[id];
+  };
+
+  void set_string_length(uint16_t id, uint16_t l) {
+    if(!string_sizes[id]) return;
+    string_arena[string_offsets[id] + l] = 0;
+    string_lengths[id] = l;
+  };
+#else
+  const char *get_string(uint16_t id) {
+    return string_valid(id, BP_ERROR_STRING_GET) ? strings[id] : "";
+  };
+
+  uint16_t string_length(uint16_t id) {
+    return string_valid(id, BP_ERROR_STRING_GET) ? strlen(strings[id]) : 0;
+  };
+
+  char get_string_char(uint16_t id, uint16_t i) {
+    return string_valid(id, BP_ERROR_STRING_GET) ? strings[id][i] : 0;
+  };
+
+  void set_string_char(uint16_t id, uint16_t i, char c) {
+    if(string_valid(id, BP_ERROR_STRING_SET)) strings[id][i] = c;
+  };
+
+  void copy_string(uint16_t d, uint16_t s) {
+    if(
+      !string_valid(d, BP_ERROR_STRING_SET) ||
+      !string_valid(s, BP_ERROR_STRING_GET)
+    ) return;
+    for(uint16_t i = 0; i < BP_STRING_MAX_LENGTH; i++)
+      strings[d][i] = strings[s][i];
+  };
+
+  void literal_string(uint16_t id) {
+    if(string_valid(id, BP_ERROR_STRING_SET))
+      literal(strings[id], sizeof(strings[id]));
+  };
+
+  char *string_space(uint16_t id, uint16_t) {
+    return string_valid(id, BP_ERROR_STRING_SET) ? strings[id] : NULL;
+  };
+  void set_string_length(uint16_t id, uint16_t l) { strings[id][l] = 0; };
+#endif
+
+  /* STRING OPERAND - :s, :[i] or a literal copied in d ------------------
+     Returns the id of the string or BP_STRINGS for literals. */
+  uint16_t string_operand(char *d) {
+    *d = 0;
+    if(decoder_get() == BP_STRING) {
+      literal(d, BP_STRING_MAX_LENGTH);
+      decoder_next();
+      return BP_STRINGS;
+    }
+    if(decoder_get() == BP_STR_ACCESS)
+      return bound(access(BP_STR_ACCESS), BP_STRINGS, BP_ERROR_STRING_GET);
+    if(ignore(BP_S_ADDRESS)) return decoder_last_id();
+    error(decoder_position(), BP_ERROR_SYMBOL);
+    return BP_STRINGS;
+  };
+
+  const char *operand_text(uint16_t id, const char *d) {
+    return (id < BP_STRINGS) ? get_string(id) : d;
+  };
+
+  uint16_t operand_length(uint16_t id, const char *d) {
+    return (id < BP_STRINGS) ? string_length(id) : strlen(d);
   };
 
   /* UNARY OPERATOR -------------------------------------------------------- */
@@ -187,11 +983,12 @@ class BIPLAN_Interpreter {
   /* NUMERIC VARIABLE: 1234 -------------------------------------------------*/
   BP_VAR_TYPE var_factor() {
     BP_VAR_TYPE v;
-    int8_t pre = unary(), post = 0, id = BP_VARIABLES;
+    int8_t pre = unary(), post = 0;
+    int id;
     bool index = ignore(BP_INDEX);
     uint8_t type = decoder_get();
     decoder_next();
-    id = *(decoder_position() - 1) - BP_OFFSET;
+    id = decoder_last_id();
     if(index && ((type == BP_ADDRESS) || (type == BP_S_ADDRESS)))
       return id + pre;
     if(type == BP_ADDRESS) {
@@ -200,7 +997,10 @@ class BIPLAN_Interpreter {
         post = unary();
       if((pre != 0) || (post != 0)) set_variable(id, v + pre + post);
     } else if((type == BP_S_ADDRESS) && (decoder_get() == BP_ACCESS)) {
-      v = strings[id][access(BP_ACCESS)];
+      v = access(BP_ACCESS);
+      v = get_string_char(
+        id, bound(v, BP_STRING_MAX_LENGTH, BP_ERROR_STRING_GET)
+      );
       return_type = BP_ACCESS;
     } else {
       return_type = BP_S_ADDRESS;
@@ -218,30 +1018,99 @@ class BIPLAN_Interpreter {
     return v;
   };
 
+  /* TYPED MEMORY VIEW: @16[i] @s16[i] ----------------------------------
+     The index selects the i-th element of the given width, elements are
+     stored little-endian byte by byte so any width can be accessed on any
+     architecture regardless of alignment (see BIPLAN_Memory.h). @[i] is a
+     view of unsigned bytes. */
+  bp_mem_view_t mem_view(const char *e) {
+    bp_mem_view_t v = {memory, 1, (decoder_get() == BP_MEM_SVIEW)};
+    BP_VAR_TYPE i;
+    if(decoder_get() == BP_MEM_ACCESS) i = access(BP_MEM_ACCESS);
+    else {
+      decoder_next();
+      BP_VAR_TYPE w = number();
+      expect(BP_NUMBER);
+      v.bytes = w / 8;
+      if((w % 8) || !v.bytes || (v.bytes > 8) || (v.bytes & (v.bytes - 1))) {
+        error(decoder_position(), BP_ERROR_MEM_VIEW);
+        v.bytes = 1;
+      }
+      i = access(BP_ACCESS);
+    }
+    #ifdef BP_MEM_REGIONS // Mapped regions are looked up first
+      uint8_t r = BP_MEM_REGIONS;
+      if((i >= 0) && (i <= (BP_VAR_MAX / v.bytes)))
+        r = mem_region_at(i * v.bytes, v.bytes);
+      if(r < BP_MEM_REGIONS) {
+        v.data = regions[r].data + ((i * v.bytes) - regions[r].address);
+        if(regions[r].fence) BPM_MEM_FENCE();
+        return v;
+      }
+    #endif
+    v.data += bound(i, BP_MEM_SIZE / v.bytes, e) * v.bytes;
+    return v;
+  };
+
+  /* Bound the amount of elements of a range starting from a view */
+  uint32_t mem_range(const bp_mem_view_t &v, BP_VAR_TYPE n, const char *e) {
+    const uint8_t *end = memory + BP_MEM_SIZE;
+    #ifdef BP_MEM_REGIONS
+      uint8_t r = mem_region_of(v.data);
+      if(r < BP_MEM_REGIONS) end = regions[r].data + regions[r].length;
+    #endif
+    return bound(n, ((end - v.data) / v.bytes) + 1, e);
+  };
+
+  BP_VAR_TYPE mem_view_read() {
+    bp_mem_view_t v = mem_view(BP_ERROR_MEM_GET);
+    return (BP_VAR_TYPE)bp_mem_load(v.data, v.bytes, v.sign);
+  };
+
   /* FACTOR: (n) ---------------------------------------------------------- */
   BP_VAR_TYPE factor() {
     BP_VAR_TYPE v = 0;
     bool bitwise_not = ignore(BP_BITWISE_NOT), minus = ignore(BP_MINUS);
     switch(decoder_get()) {
-      case BP_VAR_ACCESS: v = variables[access(BP_VAR_ACCESS)]; break;
+      case BP_VAR_ACCESS:
+        v = access(BP_VAR_ACCESS);
+        v = variables[bound(v, BP_VARIABLES, BP_ERROR_VARIABLE_GET)];
+        break;
       case BP_STR_ACCESS:
-        v = access(BP_STR_ACCESS);
-        if(decoder_get() == BP_ACCESS) v = strings[v][access(BP_ACCESS)];
+        v = bound(access(BP_STR_ACCESS), BP_STRINGS, BP_ERROR_STRING_GET);
+        if(decoder_get() == BP_ACCESS) {
+          BP_VAR_TYPE c = access(BP_ACCESS);
+          c = bound(c, BP_STRING_MAX_LENGTH, BP_ERROR_STRING_GET);
+          v = get_string_char(v, c);
+        } break;
+      case BP_MEM_ACCESS: // With mapped regions resolved by mem_view
+      #ifndef BP_MEM_REGIONS
+        v = memory[bound(access(BP_MEM_ACCESS), BP_MEM_SIZE, BP_ERROR_MEM_GET)];
         break;
-      case BP_MEM_ACCESS: v = memory[access(BP_MEM_ACCESS)]; break;
-      case BP_NUMBER: v = BPM_ATOL(decoder_position()); expect(BP_NUMBER); break;
+      #endif
+      case BP_MEM_VIEW: ;
+      case BP_MEM_SVIEW: v = mem_view_read(); break;
+      case BP_MEMSUM: decoder_next(); v = mem_sum_call(); break;
+      case BP_MEMDOT: decoder_next(); v = mem_dot_call(); break;
+      case BP_NUMBER: v = number(); expect(BP_NUMBER); break;
       case BP_DREAD: decoder_next(); return BPM_IO_READ(expression());
+      case BP_PINS_READ: decoder_next(); v = pins_read_call(); break;
       case BP_MILLIS: decoder_next(); v = (BPM_MILLIS() % BP_VAR_MAX); break;
       case BP_AGET: decoder_next(); v = BPM_AREAD(expression()); break;
       case BP_RND: decoder_next();  v = random_call(); break;
-      case BP_SQRT: decoder_next(); v = sqrt(expression()); break;
+      case BP_SQRT: decoder_next(); v = BPM_SQRT(expression()); break;
       case BP_FUNCTION: v = function_call(); decoder_next(); break;
+      case BP_NATIVE: v = native_call(); break;
+      case BP_TRYRECV: v = tryrecv_call(); break;
       case BP_SERIAL_RX:
-        v = BPM_SERIAL_READ(serial_fun); decoder_next(); break;
-      case BP_INPUT: v = BPM_INPUT(data_in_fun); decoder_next(); break;
+        print_flush(); v = BPM_SERIAL_READ(serial_fun); decoder_next(); break;
+      case BP_INPUT:
+        print_flush(); v = BPM_INPUT(data_in_fun); decoder_next(); break;
       case BP_L_RPARENT:
         decoder_next(); v = relation(); expect(BP_R_RPARENT); break;
       case BP_SIZEOF: v = sizeof_call(); break;
+      case BP_STRCMP: decoder_next(); v = strcmp_call(); break;
+      case BP_STRFIND: decoder_next(); v = strfind_call(); break;
       case BP_ATOL: v = atol_call(); break;
       case BP_NUMERIC: decoder_next(); v = relation(); v = (v >= 48) && (v <= 57); break;
       default: v = var_factor();
@@ -317,9 +1186,54 @@ class BIPLAN_Interpreter {
   /* JUMP ------------------------------------------------------------------ */
   void jump_call() {
     decoder_next();
-    decoder_goto(program_start + relation());
+    BP_VAR_TYPE p = relation();
+    decoder_goto(
+      program_start + bound(p, program_end - program_start, BP_ERROR_JUMP)
+    );
   }
 
+  /* DELAY ----------------------------------------------------------------- */
+  void delay_call() {
+    BP_VAR_TYPE v = expression();
+    print_flush();
+    BPM_DELAY(v);
+  };
+
+  /* PRINT OUTPUT ---------------------------------------------------------- */
+#ifdef BP_PRINT_BUFFER
+  void print_flush() {
+    if(print_length) {
+      print_buffer[print_length] = 0;
+      BPM_PRINT_WRITE(print_fun, (const char *)print_buffer);
+      print_length = 0;
+    } BPM_PRINT_FLUSH(print_fun);
+  };
+
+  void print_write(char c) {
+    if(print_length == BP_PRINT_BUFFER) print_flush();
+    print_buffer[print_length++] = c;
+    #if BP_PRINT_FLUSH_POLICY == BP_FLUSH_LINE
+      if(c == '\n') print_flush();
+    #endif
+  };
+
+  void print_write(const char *s) { while(*s) print_write(*(s++)); };
+
+  void print_write(BP_VAR_TYPE v) {
+    char n[BP_NUM_MAX_LENGTH + 2];
+    for(uint8_t i = 0, l = bp_ltoa(n, v, 10); i < l; i++) print_write(n[i]);
+  };
+#else
+  void print_flush() { BPM_PRINT_FLUSH(print_fun); };
+  void print_write(char c) { BPM_PRINT_WRITE(print_fun, c); };
+  void print_write(const char *s) { BPM_PRINT_WRITE(print_fun, s); };
+  void print_write(BP_VAR_TYPE v) {
+    char n[BP_NUM_MAX_LENGTH + 2];
+    bp_ltoa(n, v, 10);
+    BPM_PRINT_WRITE(print_fun, (const char *)n);
+  };
+#endif
+
   /* PRINT ----------------------------------------------------------------- */
   void print_call() {
     do {
@@ -327,30 +1241,91 @@ class BIPLAN_Interpreter {
       ignore(BP_COMMA);
       bool is_char = ignore(BP_CHAR);
       if(decoder_get() == BP_STR_ACCESS) {
-        BPM_PRINT_WRITE(print_fun, strings[access(BP_STR_ACCESS)]);
+        v = bound(access(BP_STR_ACCESS), BP_STRINGS, BP_ERROR_STRING_GET);
+        print_write(get_string(v));
       } else if(decoder_get() == BP_STRING) {
-        decoder_string(string, sizeof(string));
-        BPM_PRINT_WRITE(print_fun, string);
+        literal(string, sizeof(string));
+        print_write(string);
         decoder_next();
       } else if(decoder_get() == BP_S_ADDRESS) {
         v = var_factor();
         if(return_type == BP_ACCESS) {
-          if(is_char) BPM_PRINT_WRITE(print_fun, (char)v);
-          else BPM_PRINT_WRITE(print_fun, v);
-        } else BPM_PRINT_WRITE(print_fun, strings[v]);
+          if(is_char) print_write((char)v);
+          else print_write(v);
+        } else
+          print_write(get_string(bound(v, BP_STRINGS, BP_ERROR_STRING_GET)));
       } else {
+        return_type = 0; // Set by var_factor if a string is returned
         v = relation();
         if(return_type == BP_S_ADDRESS)
-          BPM_PRINT_WRITE(print_fun, strings[v]);
-        else if(is_char) BPM_PRINT_WRITE(print_fun, (char)v);
-        else BPM_PRINT_WRITE(print_fun, v);
+          print_write(get_string(bound(v, BP_STRINGS, BP_ERROR_STRING_GET)));
+        else if(is_char) print_write((char)v);
+        else print_write(v);
       }
     } while(decoder_get() == BP_COMMA);
+    #if defined(BP_PRINT_BUFFER) && (BP_PRINT_FLUSH_POLICY == BP_FLUSH_PRINT)
+      print_flush();
+    #endif
+  };
+
+  /* PRINTF --------------------------------------------------------------- */
+  void printf_char(char *out, uint16_t &l, char c) {
+    if(l == BP_PRINTF_MAX_LENGTH) {
+      out[l] = 0;
+      print_write((const char *)out);
+      l = 0;
+    }
+    if(c) out[l++] = c;
   };
 
-  /* BLOCK CALL ------------------------------------------------------------ */
-  void skip_block() {
-    uint16_t id = 1;
+  void printf_call() {
+    char out[BP_PRINTF_MAX_LENGTH + 1], n[BP_NUM_MAX_LENGTH + 2];
+    const char *s;
+    bp_code_t f = decoder_position() + 1;
+    uint16_t l = 0;
+    uint8_t t, w, length;
+    decoder_next(); // The format is checked by verify
+    for(; (t = decoder_read(f)) && (t != BP_STRING) && !ended; f++) {
+      if((t < BP_FMT_NUMBER) || (t > BP_FMT_STRING)) {
+        printf_char(out, l, t);
+        continue;
+      }
+      w = decoder_read(++f);
+      char pad = (w & BP_FMT_ZERO) ? '0' : ' ';
+      w = (w & ~BP_FMT_ZERO) - 1;
+      expect(BP_COMMA);
+      if(t == BP_FMT_STRING) {
+        uint16_t id = string_operand(string);
+        s = operand_text(id, string);
+        length = operand_length(id, string);
+      } else {
+        BP_VAR_TYPE v = relation();
+        if(t == BP_FMT_CHAR) {
+          n[0] = v;
+          length = 1;
+        } else length = bp_ltoa(n, v, (t == BP_FMT_HEX) ? 16 : 10);
+        s = n;
+        if((pad == '0') && (*s == '-')) {
+          printf_char(out, l, *(s++));
+          length--;
+          if(w) w--;
+        }
+      }
+      for(; length < w; w--) printf_char(out, l, pad);
+      while(length--) printf_char(out, l, *(s++));
+    }
+    out[l] = 0;
+    if(l) print_write((const char *)out);
+    #if defined(BP_PRINT_BUFFER) && (BP_PRINT_FLUSH_POLICY == BP_FLUSH_PRINT)
+      print_flush();
+    #endif
+  };
+
+  /* BLOCK CALL (from is the position of the opening code) ---------------- */
+  void skip_block(bp_code_t from) {
+    bp_code_t end = block_end(from);
+    if(end) return decoder_goto(end);
+    uint32_t id = 1;
     do {
       if(decoder_get() == BP_IF) id++;
       if(decoder_get() == BP_ENDIF) id--;
@@ -363,9 +1338,10 @@ class BIPLAN_Interpreter {
 
   /* IF -------------------------------------------------------------------- */
   void if_call() {
+    bp_code_t p = decoder_position();
     decoder_next();
     if((BP_VAR_TYPE)(relation()) > 0) return;
-    skip_block();
+    skip_block(p);
     ignore(BP_ELSE);
   };
 
@@ -373,46 +1349,116 @@ class BIPLAN_Interpreter {
   void variable_assignment_call() {
     if(decoder_get() == BP_VAR_ACCESS) {
       BP_VAR_TYPE v = access(BP_VAR_ACCESS);
-      return set_variable(v, relation());
+      v = bound(v, BP_VARIABLES, BP_ERROR_VARIABLE_SET);
+      variables[v] = relation();
     } else {
       decoder_next();
-      int vi = *(decoder_position() - 1) - BP_OFFSET;
+      int vi = decoder_last_id();
       set_variable(vi, relation());
     }
   };
 
   /* ASSIGN VALUE TO STRING ----------------------------------------------- */
   void string_assignment_call() {
-    int ci = BP_STRING_MAX_LENGTH, si;
+    int ci, si;
     bool str_acc = (decoder_get() == BP_STR_ACCESS);
     decoder_next();
     if(str_acc) {
-      si = expression();
+      si = bound(expression(), BP_STRINGS, BP_ERROR_STRING_SET);
       expect(BP_ACCESS_END);
-    } else si = *(decoder_position() - 1) - BP_OFFSET;
-    if(decoder_get() == BP_ACCESS) ci = access(BP_ACCESS);
-    if(ci == BP_STRING_MAX_LENGTH) {
-      if(decoder_get() == BP_STRING) {
-        decoder_string(strings[si], sizeof(strings[si]));
-        expect(BP_STRING);
-      } else if(ignore(BP_S_ADDRESS)) {
-        ci = *(decoder_position() - 1) - BP_OFFSET;
-        for(uint16_t i = 0; i < sizeof(strings[ci]); i++)
-          strings[si][i] = strings[ci][i];
-        decoder_next();
-      }
-    } else {
+    } else si = decoder_last_id();
+    if(decoder_get() == BP_ACCESS) {
+      ci = access(BP_ACCESS);
+      ci = bound(ci, BP_STRING_MAX_LENGTH, BP_ERROR_STRING_SET);
       if(ignore(BP_STRING)) {
-        strings[si][ci] = (char)(*(decoder_position() - 2));
-      } else strings[si][ci] = (uint8_t)expression();
-    }
+        set_string_char(si, ci, decoder_read(decoder_position() - 2));
+      } else set_string_char(si, ci, (uint8_t)expression());
+    } else if(decoder_get() == BP_STRING) {
+      literal_string(si);
+      expect(BP_STRING);
+    } else if(ignore(BP_S_ADDRESS)) copy_string(si, decoder_last_id());
   };
 
   /* GENERAL PURPOSE MEMORY ASSIGNMENT ------------------------------------ */
   void mem_assignment_call() {
-    BP_VAR_TYPE i = access(BP_MEM_ACCESS);
-    if((i >= 0) && (i < BP_MEM_SIZE)) memory[i] = expression();
-    else error(decoder_position(), BP_ERROR_MEM_SET);
+    #ifdef BP_MEM_REGIONS
+      mem_view_assignment_call();
+    #else
+      BP_VAR_TYPE i = access(BP_MEM_ACCESS);
+      memory[bound(i, BP_MEM_SIZE, BP_ERROR_MEM_SET)] = expression();
+    #endif
+  };
+
+  /* TYPED MEMORY ASSIGNMENT (signed and unsigned store the same bytes) --- */
+  void mem_view_assignment_call() {
+    bp_mem_view_t v = mem_view(BP_ERROR_MEM_SET);
+    bp_mem_store(v.data, v.bytes, expression());
+    mem_written(v, 1);
+  };
+
+  /* BULK MEMORY OPERATIONS ------------------------------------------------
+     Ranges are a view (@[i], @16[i], @s16[i]...) and an amount of elements,
+     the elements are processed natively (see BIPLAN_Memory.h). */
+  void mem_fill_call() {
+    bp_mem_view_t v = mem_view(BP_ERROR_MEM_SET);
+    expect(BP_COMMA);
+    uint32_t n = mem_range(v, expression(), BP_ERROR_MEM_SET);
+    expect(BP_COMMA);
+    bp_mem_fill(v, n, expression());
+    mem_written(v, n);
+  };
+
+  void mem_copy_call() {
+    bp_mem_view_t d = mem_view(BP_ERROR_MEM_SET);
+    expect(BP_COMMA);
+    bp_mem_view_t s = mem_view(BP_ERROR_MEM_GET);
+    expect(BP_COMMA);
+    uint32_t n = mem_range(d, expression(), BP_ERROR_MEM_SET);
+    n = mem_range(s, n, BP_ERROR_MEM_GET);
+    bp_mem_copy(d, s, n);
+    mem_written(d, n);
+  };
+
+  BP_VAR_TYPE mem_sum_call() {
+    bp_mem_view_t v = mem_view(BP_ERROR_MEM_GET);
+    expect(BP_COMMA);
+    return bp_mem_sum(v, mem_range(v, expression(), BP_ERROR_MEM_GET));
+  };
+
+  BP_VAR_TYPE mem_dot_call() {
+    bp_mem_view_t a = mem_view(BP_ERROR_MEM_GET);
+    expect(BP_COMMA);
+    bp_mem_view_t b = mem_view(BP_ERROR_MEM_GET);
+    expect(BP_COMMA);
+    uint32_t n = mem_range(a, expression(), BP_ERROR_MEM_GET);
+    return bp_mem_dot(a, b, mem_range(b, n, BP_ERROR_MEM_GET));
+  };
+
+  void mem_minmax_call() {
+    int64_t min, max;
+    uint16_t id[2];
+    bp_mem_view_t v = mem_view(BP_ERROR_MEM_GET);
+    expect(BP_COMMA);
+    bp_mem_minmax(v, mem_range(v, expression(), BP_ERROR_MEM_GET), min, max);
+    for(uint8_t i = 0; i < 2; i++) { // Results are assigned to $min, $max
+      expect(BP_COMMA);
+      id[i] = decoder_id(decoder_position());
+      expect(BP_ADDRESS);
+    }
+    set_variable(id[0], min);
+    set_variable(id[1], max);
+  };
+
+  void mem_scale_call() {
+    bp_mem_view_t v = mem_view(BP_ERROR_MEM_SET);
+    expect(BP_COMMA);
+    uint32_t n = mem_range(v, expression(), BP_ERROR_MEM_SET);
+    expect(BP_COMMA);
+    BP_VAR_TYPE mul = expression();
+    expect(BP_COMMA);
+    BP_VAR_TYPE shift = expression();
+    bp_mem_scale(v, n, mul, (shift < 0) ? 0 : (shift > 63) ? 63 : shift);
+    mem_written(v, n);
   };
 
   /* RETURN --------------------------------------------------------------- */
@@ -442,35 +1488,181 @@ class BIPLAN_Interpreter {
 
   /* FUNCTION -------------------------------------------------------------- */
   BP_VAR_TYPE function_call() {
+    if(fun_id >= BP_FUN_DEPTH) {
+      error(decoder_position(), BP_ERROR_FUNCTION_CALL);
+      return 0;
+    }
     functions[fun_id].cycle_id = cycle_id;
     int16_t i = 0;
     expect(BP_FUNCTION);
-    uint16_t f = *(decoder_position() - 1) - BP_OFFSET, v = BP_VARIABLES;
-    if((*(decoder_position() + 1) == BP_R_RPARENT))
+    uint16_t f = decoder_last_id();
+    uint16_t v = BP_VARIABLES;
+    if((decoder_read(decoder_position() + 1) == BP_R_RPARENT))
       expect(BP_L_RPARENT); // If call with no params
     else if(ignore(BP_L_RPARENT))
       do {
-        v = definitions[f].params[i] - BP_OFFSET;
+        v = definitions[f].params[i];
         functions[fun_id].params[i].id = v;
         if(v != BP_VARIABLES) {
           functions[fun_id].params[i].value = get_variable(v);
           set_variable(v, relation()); // Set the value of local variable
         } else relation(); // ignore unexpected parameter
       } while((++i < BP_PARAMS) && ignore(BP_COMMA));
-    if(fun_id < BP_FUN_DEPTH) {
-      functions[fun_id++].address = decoder_position();
-      decoder_goto(definitions[f].address);
-      while(decoder_get() != BP_RETURN) statement();
-      return return_call();
-    } else {
-      error(decoder_position(), BP_ERROR_FUNCTION_CALL);
+    functions[fun_id++].address = decoder_position();
+    decoder_goto(definitions[f].address);
+    while(!ended && (decoder_get() != BP_RETURN)) statement();
+    return return_call();
+  };
+
+  /* HANDLER CALL - Events and timers, as a call from the current position */
+  void event_call(uint16_t f, BP_VAR_TYPE source) {
+    if(fun_id >= BP_FUN_DEPTH)
+      return error(decoder_position(), BP_ERROR_FUNCTION_CALL);
+    uint16_t p = definitions[f].params[0];
+    functions[fun_id].cycle_id = cycle_id;
+    if(p != BP_VARIABLES) {
+      functions[fun_id].params[0].id = p;
+      functions[fun_id].params[0].value = get_variable(p);
+      set_variable(p, source);
+    }
+    functions[fun_id++].address = decoder_position();
+    decoder_goto(definitions[f].address);
+    while(!ended && (decoder_get() != BP_RETURN)) statement();
+    if(!ended) return_call();
+  };
+
+  /* HANDLER: call f or call f(), BP_MAX_FUNCTIONS if not defined ------- */
+  uint16_t handler_operand() {
+    expect(BP_COMMA);
+    expect(BP_FUNCTION);
+    uint16_t f = decoder_last_id();
+    if(ignore(BP_L_RPARENT)) expect(BP_R_RPARENT);
+    if(ended) return BP_MAX_FUNCTIONS;
+    if((f >= BP_MAX_FUNCTIONS) || !definitions[f].address) {
+      error(decoder_position(), BP_ERROR_FUNCTION_DEFINITION);
+      return BP_MAX_FUNCTIONS;
+    } return f;
+  };
+
+  /* ON: on pin n call f, on serial call f ------------------------------- */
+  void on_call() {
+    uint8_t type = BP_EVENT_SERIAL;
+    BP_VAR_TYPE source = 0;
+    decoder_next();
+    if(ignore(BP_PIN)) {
+      type = BP_EVENT_PIN;
+      source = expression();
+    } else expect(BP_SERIAL);
+    uint16_t f = handler_operand();
+    if((f != BP_MAX_FUNCTIONS) && !attach_event(type, source, f))
+      error(decoder_position(), BP_ERROR_EVENT);
+  };
+
+  /* EVERY: every ms call f, every 0 call f removes it -------------------
+     Deadlines are compared as signed 32 bits differences, periods longer
+     than INT32_MAX milliseconds (about 24 days) raise an error. */
+  void every_call() {
+    decoder_next();
+    BP_VAR_TYPE period = expression();
+    uint16_t f = handler_operand();
+    if(f == BP_MAX_FUNCTIONS) return;
+    if((period < 0) || ((int64_t)period > INT32_MAX))
+      return error(decoder_position(), BP_ERROR_TIMER);
+    if(!attach_timer(period, f)) error(decoder_position(), BP_ERROR_TIMER);
+  };
+
+  /* NATIVE FUNCTION CALL ------------------------------------------------
+     Arguments are evaluated in order in the array passed to the function,
+     their amount is checked by verify. */
+  BP_VAR_TYPE native_call() {
+    BP_VAR_TYPE args[BP_PARAMS];
+    uint16_t id = decoder_id(decoder_position());
+    if(id >= native_count) {
+      error(decoder_position(), BP_ERROR_NATIVE);
       return 0;
     }
+    decoder_next();
+    expect(BP_L_RPARENT);
+    for(uint8_t i = 0; (i < natives[id].params) && (i < BP_PARAMS); i++) {
+      if(i) expect(BP_COMMA);
+      args[i] = relation();
+    }
+    expect(BP_R_RPARENT);
+    return (ended) ? 0 : natives[id].fun(args);
+  };
+
+  /* CHANNEL CALLS: send, recv, tryrecv ---------------------------------------
+     If the channel is full (send) or empty (recv) the statement is left
+     as it is and waiting is set: run returns and executes it again the
+     next time, so the host can run other interpreters or wait. Within a
+     function the call waits in place calling BPM_CHANNEL_WAIT. */
+  bp_channel_t *channel_operand() {
+    bp_channel_t *c = channel(expression());
+    if(!c) error(decoder_position(), BP_ERROR_CHANNEL);
+    return c;
+  };
+
+  /* True if the statement at p is executed again by the next run */
+  bool channel_blocked(bp_code_t p) {
+    if(!fun_id) {
+      print_flush();
+      decoder_goto(p);
+      return waiting = true;
+    }
+    BPM_CHANNEL_WAIT();
+    return false;
+  };
+
+  void send_call() {
+    bp_code_t p = decoder_position();
+    decoder_next();
+    bp_channel_t *c = channel_operand();
+    if(!c) return;
+    // The value is evaluated only once there is space
+    while(bp_channel_full(*c)) if(channel_blocked(p)) return;
+    expect(BP_COMMA);
+    BP_VAR_TYPE v = relation();
+    // Other producers may fill the channel in the meantime
+    while(!ended && !bp_channel_send(*c, v)) BPM_CHANNEL_WAIT();
+  };
+
+  void recv_call() {
+    bp_code_t p = decoder_position();
+    BP_VAR_TYPE v;
+    decoder_next();
+    bp_channel_t *c = channel_operand();
+    expect(BP_COMMA);
+    expect(BP_ADDRESS);
+    uint16_t id = decoder_last_id();
+    if(!c || ended) return;
+    while(!bp_channel_recv(*c, v)) if(channel_blocked(p)) return;
+    set_variable(id, v);
+  };
+
+  /* Returns 1 and sets the variable if a value is received, otherwise 0 */
+  BP_VAR_TYPE tryrecv_call() {
+    BP_VAR_TYPE v;
+    decoder_next();
+    bp_channel_t *c = channel_operand();
+    expect(BP_COMMA);
+    expect(BP_ADDRESS);
+    if(!c || ended || !bp_channel_recv(*c, v)) return 0;
+    set_variable(decoder_last_id(), v);
+    return 1;
   };
 
   /* CONTINUE -------------------------------------------------------------- */
   void continue_call() {
-    int16_t id = cycle_id;
+    if(cycle_id && cycles[cycle_id - 1].end)
+      return decoder_goto(cycles[cycle_id - 1].end);
+    skip_cycle(0);
+  };
+
+  /* MOVE TO THE NEXT OF A CYCLE (from is the position of for or while) --- */
+  void skip_cycle(bp_code_t from) {
+    bp_code_t end = block_end(from);
+    if(end) return decoder_goto(end);
+    int32_t id = cycle_id;
     while(cycle_id <= id) {
       if(decoder_get() == BP_NEXT) id--;
       if(decoder_get() == BP_WHILE || decoder_get() == BP_FOR) id++;
@@ -489,15 +1681,16 @@ class BIPLAN_Interpreter {
 
   /* CYCLE ----------------------------------------------------------------- */
   void for_call() {
+    bp_code_t p = decoder_position();
     decoder_next();
     expect(BP_ADDRESS);
-    uint8_t vi = *(decoder_position() - 1) - BP_OFFSET;
+    uint16_t vi = decoder_last_id();
     BP_VAR_TYPE l, v;
     if(cycle_id < BP_CYCLE_DEPTH) {
       v = expression();
       expect(BP_COMMA);
       if((l = expression()) == v) {
-        continue_call();
+        skip_cycle(p);
         return decoder_next();
       }
       set_variable(vi, v);
@@ -507,14 +1700,17 @@ class BIPLAN_Interpreter {
       if(ignore(BP_COMMA)) cycles[cycle_id - 1].step = relation();
       else cycles[cycle_id - 1].step = (v < l) ? 1 : -1;
       cycles[cycle_id - 1].address = decoder_position();
-    } else error_fun(decoder_position(), BP_ERROR_CYCLE_MAX);
+      cycles[cycle_id - 1].end = block_end(p);
+    } else error_fun(
+      error_position(decoder_position()), BP_ERROR_CYCLE_MAX
+    );
   };
 
   /* LABEL ----------------------------------------------------------------- */
   void label_call() {
     decoder_next();
     decoder_next();
-    int id = *(decoder_position() - 1) - BP_OFFSET;
+    int id = decoder_last_id();
     set_variable(id, decoder_position() - program_start);
   };
 
@@ -523,14 +1719,14 @@ class BIPLAN_Interpreter {
     decoder_next();
     if(cycle_id) {
       if(cycles[cycle_id - 1].var_id == BP_VARIABLES) {
-        char *end = decoder_position();
+        bp_code_t end = decoder_position();
         decoder_goto(cycles[cycle_id - 1].address);
         if(relation() <= 0) {
           decoder_goto(end);
           cycle_id--;
         }
       } else {
-        uint8_t vi = cycles[cycle_id - 1].var_id;
+        uint16_t vi = cycles[cycle_id - 1].var_id;
         variables[vi] += cycles[cycle_id - 1].step;
         if(variables[vi] != cycles[cycle_id - 1].to)
           decoder_goto(cycles[cycle_id - 1].address);
@@ -544,11 +1740,17 @@ class BIPLAN_Interpreter {
 
   /* WHILE ----------------------------------------------------------------- */
   void while_call() {
-    char *start = decoder_position();
+    bp_code_t start = decoder_position();
     if(relation() > 0) {
-      if(cycle_id < BP_CYCLE_DEPTH) cycles[cycle_id++].address = start;
-      else error(decoder_position(), BP_ERROR_WHILE_MAX);
-    } else break_call();
+      if(cycle_id < BP_CYCLE_DEPTH) {
+        cycles[cycle_id].end = block_end(start - 1);
+        cycles[cycle_id].var_id = BP_VARIABLES; // May be left by return
+        cycles[cycle_id++].address = start;
+      } else error(decoder_position(), BP_ERROR_WHILE_MAX);
+    } else { // Skip the cycle without touching the cycles buffer
+      skip_cycle(start - 1);
+      decoder_next();
+    }
   };
 
   /* DIGITAL WRITE --------------------------------------------------------- */
@@ -558,6 +1760,62 @@ class BIPLAN_Interpreter {
     BPM_IO_WRITE(pin, expression());
   };
 
+  /* PORT-WIDE IO: first pin, amount of pins (max 32), mask --------------- */
+  uint8_t pins_count() {
+    BP_VAR_TYPE n;
+    expect(BP_COMMA);
+    n = expression();
+    return (n < 0) ? 0 : (n > 32) ? 32 : n;
+  };
+
+  void pins_write_call() {
+    BP_VAR_TYPE pin = expression();
+    uint8_t n = pins_count();
+    expect(BP_COMMA);
+    uint32_t mask = expression();
+    #ifdef BPM_IO_WRITE_MASK
+      BPM_IO_WRITE_MASK(pin, n, mask);
+    #else
+      for(uint8_t i = 0; i < n; i++, mask >>= 1)
+        BPM_IO_WRITE(pin + i, mask & 1);
+    #endif
+  };
+
+  BP_VAR_TYPE pins_read_call() {
+    BP_VAR_TYPE pin = expression();
+    uint8_t n = pins_count();
+    #ifdef BPM_IO_READ_MASK
+      return BPM_IO_READ_MASK(pin, n);
+    #else
+      uint32_t mask = 0;
+      for(uint8_t i = n; i; i--) mask = (mask << 1) | BPM_IO_READ(pin + i - 1);
+      return mask;
+    #endif
+  };
+
+  /* SHIFT OUT: data pin, clock pin, memory range, most significant first -- */
+  void shift_out_call() {
+    BP_VAR_TYPE data = expression();
+    expect(BP_COMMA);
+    BP_VAR_TYPE clock = expression();
+    expect(BP_COMMA);
+    bp_mem_view_t v = mem_view(BP_ERROR_MEM_GET);
+    expect(BP_COMMA);
+    uint32_t n = mem_range(v, expression(), BP_ERROR_MEM_GET);
+    for(uint8_t *e = v.data; n; n--, e += v.bytes)
+      for(uint8_t b = v.bytes; b; b--) {
+        #ifdef BPM_IO_SHIFT_OUT
+          BPM_IO_SHIFT_OUT(data, clock, e[b - 1]);
+        #else
+          for(uint8_t i = 0, c = e[b - 1]; i < 8; i++, c <<= 1) {
+            BPM_IO_WRITE(data, (c & 0x80) ? 1 : 0);
+            BPM_IO_WRITE(clock, 1);
+            BPM_IO_WRITE(clock, 0);
+          }
+        #endif
+      }
+  };
+
   /* PINMODE --------------------------------------------------------------- */
   void pinMode_call() {
     BP_VAR_TYPE pin = expression();
@@ -565,35 +1823,119 @@ class BIPLAN_Interpreter {
     BPM_IO_MODE(pin, expression());
   }
 
+  /* ANALOG BURST: pin, view, samples, interval in microseconds ------------ */
+  void analog_burst_call() {
+    BP_VAR_TYPE pin = expression();
+    expect(BP_COMMA);
+    bp_mem_view_t v = mem_view(BP_ERROR_MEM_SET);
+    expect(BP_COMMA);
+    uint32_t n = mem_range(v, expression(), BP_ERROR_MEM_SET);
+    expect(BP_COMMA);
+    BP_VAR_TYPE interval = expression();
+    if(interval < 0) interval = 0;
+    BPM_AREAD_BURST(pin, v.data, v.bytes, n, (uint32_t)interval);
+    mem_written(v, n);
+  };
+
   /* RANDOM CALL (min optional, max optional) ------------------------------ */
   BP_VAR_TYPE random_call() {
     BP_VAR_TYPE a = expression(), b;
-    if(ignore(BP_COMMA)) b = BPM_RANDOM(a, expression());
-    else b = BPM_RANDOM(a);
+    #ifdef BPM_RANDOM
+      if(ignore(BP_COMMA)) b = BPM_RANDOM(a, expression());
+      else b = BPM_RANDOM(a);
+    #else
+      if(ignore(BP_COMMA)) b = bp_random(random_state, a, expression());
+      else b = bp_random(random_state, 0, a);
+    #endif
     return b;
   };
 
+  /* RANDOM SEED - The same seed repeats the same sequence of numbers ----- */
+  void random_seed(uint32_t seed) {
+    random_state = seed;
+    #ifdef BPM_RANDOM_SEED
+      BPM_RANDOM_SEED(seed);
+    #endif
+  };
+
   /* SERIAL TX CALL -------------------------------------------------------- */
   void serial_tx_call() {
     if(decoder_get() == BP_STRING) {
-      decoder_string(string, sizeof(string));
-      for(uint16_t i = 0; i < BP_STRING_MAX_LENGTH; i++)
-        BPM_SERIAL_WRITE(serial_fun, string[i]);
+      literal(string, sizeof(string));
+      BPM_SERIAL_WRITE_BUF(serial_fun, string, strlen(string));
       decoder_next();
     } else if(ignore(BP_S_ADDRESS)) {
-      uint8_t id = *(decoder_position() - 1) - BP_OFFSET;
-      for(uint16_t i = 0; i < sizeof(strings[id]); i++)
-        BPM_SERIAL_WRITE(serial_fun, strings[id][i]);
+      uint16_t id = decoder_last_id();
+      BPM_SERIAL_WRITE_BUF(serial_fun, get_string(id), string_length(id));
     } else BPM_SERIAL_WRITE(serial_fun, relation());
   };
 
+  /* STRING COMPARISON - Returns -1, 0 or 1 ------------------------------ */
+  BP_VAR_TYPE strcmp_call() {
+    char a[BP_STRING_MAX_LENGTH];
+    uint16_t i = string_operand(a);
+    expect(BP_COMMA);
+    uint16_t j = string_operand(string);
+    const uint8_t *x = (const uint8_t *)operand_text(i, a);
+    const uint8_t *y = (const uint8_t *)operand_text(j, string);
+    uint16_t xl = operand_length(i, a), yl = operand_length(j, string);
+    uint16_t m = bp_mem_mismatch(x, y, (xl < yl) ? xl : yl);
+    if((m == xl) || (m == yl)) return (xl > yl) - (xl < yl);
+    return (x[m] > y[m]) ? 1 : -1;
+  };
+
+  /* STRING SEARCH - Returns the index of the first occurrence or -1 ---- */
+  BP_VAR_TYPE strfind_call() {
+    char a[BP_STRING_MAX_LENGTH];
+    uint16_t i = string_operand(a);
+    expect(BP_COMMA);
+    uint16_t j = string_operand(string);
+    return bp_mem_find(
+      (const uint8_t *)operand_text(i, a), operand_length(i, a),
+      (const uint8_t *)operand_text(j, string), operand_length(j, string)
+    );
+  };
+
+  /* STRING CONCATENATION ------------------------------------------------- */
+  void strcat_call() {
+    uint16_t d = string_operand(string), s, dl, sl;
+    if(d == BP_STRINGS) return error(decoder_position(), BP_ERROR_SYMBOL);
+    expect(BP_COMMA);
+    s = string_operand(string);
+    dl = string_length(d);
+    sl = operand_length(s, string);
+    if((dl + sl) >= BP_STRING_MAX_LENGTH)
+      return error(decoder_position(), BP_ERROR_STRING_SET);
+    char *p = string_space(d, dl + sl + 1);
+    if(!p) return;
+    memmove(p + dl, operand_text(s, string), sl);
+    set_string_length(d, dl + sl);
+  };
+
+  /* SUBSTRING - Copies up to length characters from start -------------- */
+  void substr_call() {
+    uint16_t d = string_operand(string), s, sl;
+    if(d == BP_STRINGS) return error(decoder_position(), BP_ERROR_SYMBOL);
+    expect(BP_COMMA);
+    s = string_operand(string);
+    expect(BP_COMMA);
+    BP_VAR_TYPE from = expression();
+    expect(BP_COMMA);
+    BP_VAR_TYPE l = expression();
+    sl = operand_length(s, string);
+    from = (from < 0) ? 0 : (from > sl) ? sl : from;
+    l = (l < 0) ? 0 : (l > (sl - from)) ? (sl - from) : l;
+    char *p = string_space(d, l + 1);
+    if(!p) return;
+    memmove(p, operand_text(s, string) + from, l);
+    set_string_length(d, l);
+  };
+
   /* STRING LENGTH CALL ---------------------------------------------------- */
   BP_VAR_TYPE sizeof_call() {
     decoder_next();
     if(ignore(BP_S_ADDRESS)) {
-      BP_VAR_TYPE l =
-        strlen(strings[*(decoder_position() - 1) - BP_OFFSET]);
-      return l;
+      return string_length(decoder_last_id());
     } else if(ignore(BP_ADDRESS)) return sizeof(BP_VAR_TYPE);
     return 0;
   };
@@ -603,12 +1945,12 @@ class BIPLAN_Interpreter {
     BP_VAR_TYPE v = 0;
     decoder_next();
     if(ignore(BP_ADDRESS)) {
-      uint8_t vi = *(decoder_position() - 1) - BP_OFFSET;
+      uint16_t vi = decoder_last_id();
       v = get_variable(vi) - 48;
     } else if(ignore(BP_S_ADDRESS)) {
-      v = BPM_ATOL(strings[*(decoder_position() - 1) - BP_OFFSET]);
+      v = BPM_ATOL(get_string(decoder_last_id()));
     } else if(decoder_get() == BP_STRING) {
-      decoder_string(string, sizeof(string));
+      literal(string, sizeof(string));
       expect(BP_STRING);
       v = BPM_ATOL(string);
     }
@@ -617,6 +1959,8 @@ class BIPLAN_Interpreter {
 
   /* STATEMENTS: (print, if, return, for, while...) ------------------------ */
   void statement() {
+    handlers_dispatch();
+    if(ended) return; // Stopped by a handler
     return_type = 0;
     switch(decoder_get()) {
       case BP_LABEL:      label_call(); return;
@@ -624,16 +1968,28 @@ class BIPLAN_Interpreter {
       case BP_ENDIF:      decoder_next(); return;
       case BP_FUNCTION:   function_call(); expect(BP_R_RPARENT);
                           return;
+      case BP_NATIVE:     native_call(); return;
+      case BP_ON:         return on_call();
+      case BP_EVERY:      return every_call();
+      case BP_SEND:       return send_call();
+      case BP_RECV:       return recv_call();
       case BP_VAR_ACCESS: ; // assignment by reference
       case BP_ADDRESS:    return variable_assignment_call();
       case BP_STR_ACCESS: ; // assignment by reference
       case BP_S_ADDRESS:  return string_assignment_call();
       case BP_MEM_ACCESS: return mem_assignment_call();
+      case BP_MEM_VIEW:   ; // signed and unsigned views store the same bytes
+      case BP_MEM_SVIEW:  return mem_view_assignment_call();
+      case BP_MEMFILL:    decoder_next(); return mem_fill_call();
+      case BP_MEMCOPY:    decoder_next(); return mem_copy_call();
+      case BP_MEMMINMAX:  decoder_next(); return mem_minmax_call();
+      case BP_MEMSCALE:   decoder_next(); return mem_scale_call();
       case BP_INCREMENT:  var_factor();  return;
       case BP_DECREMENT:  var_factor();  return;
       case BP_RETURN:     return_call(); return;
       case BP_IF:         return if_call();
-      case BP_ELSE:       decoder_next(); return skip_block();
+      case BP_ELSE:       decoder_next();
+                          return skip_block(decoder_position() - 1);
       case BP_FOR:        return for_call();
       case BP_WHILE:      decoder_next(); return while_call();
       case BP_NEXT:       return next_call();
@@ -641,10 +1997,16 @@ class BIPLAN_Interpreter {
       case BP_BREAK:      return break_call();
       case BP_CONTINUE:   return continue_call();
       case BP_PRINT:      decoder_next(); return print_call();
+      case BP_PRINTF:     decoder_next(); return printf_call();
       case BP_END:        return end_call();
       case BP_DWRITE:     decoder_next(); return digitalWrite_call();
+      case BP_ABURST:     decoder_next(); return analog_burst_call();
+      case BP_PINS_WRITE: decoder_next(); return pins_write_call();
+      case BP_SHIFT_OUT:  decoder_next(); return shift_out_call();
+      case BP_STRCAT:     decoder_next(); return strcat_call();
+      case BP_SUBSTR:     decoder_next(); return substr_call();
       case BP_PINMODE:    decoder_next(); return pinMode_call();
-      case BP_DELAY:      decoder_next(); BPM_DELAY(expression()); return;
+      case BP_DELAY:      decoder_next(); return delay_call();
       case BP_RESTART:    return restart_call();
       case BP_SERIAL_TX:  decoder_next(); return serial_tx_call();
       default: error(decoder_position(), BP_ERROR_STATEMENT);
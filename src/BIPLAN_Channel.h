@@ -0,0 +1,143 @@
+
+/* ______     ______           ______   _
+  |      | | |      | |              | | \    |
+  |_____/  | |______| |        ______| |  \   |
+  |     \  | |        |       |      | |   \  |
+  |______| | |        |______ |______| |    \_| CR.1
+  Byte coded Interpreted Programming Language
+  Giovanni Blu Mitolo 2017-2020 - gioscarab@gmail.com
+      _____              _________________________
+     |   | |            |_________________________|
+     |   | |_______________||__________   \___||_________ |
+   __|___|_|               ||          |__|   ||     |   ||
+  /________|_______________||_________________||__   |   |D
+    (O)                 |_________________________|__|___/|
+                                           \ /            |
+                                           (O)
+  BIPLAN Copyright (c) 2017-2020, Giovanni Blu Mitolo All rights reserved.
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License. */
+
+#pragma once
+#include "BIPLAN_Defines.h"
+
+/* CHANNELS ---------------------------------------------------------------
+   Bounded lock-free ring buffers of BP_VAR_TYPE values used by send, recv
+   and tryrecv to pass messages among interpreters, threads and interrupt
+   handlers. The host provides the cells (a power of two, at most 16384),
+   each one carries a sequence number telling whether it is free or full.
+   Only one consumer is supported. With one producer (SPSC) send is a few
+   loads and stores, with more producers (MPSC) they reserve a cell with a
+   compare-and-swap. The host can use bp_channel_send and bp_channel_recv
+   as well. */
+
+#if defined(__AVR__)
+  // 8 bit indexes are read and written atomically
+  typedef uint8_t bp_channel_index_t;
+  typedef int8_t bp_channel_distance_t;
+  #define BP_CHANNEL_ALIGN
+  #define BP_CHANNEL_MAX_LENGTH 64
+#else
+  typedef uint16_t bp_channel_index_t;
+  typedef int16_t bp_channel_distance_t;
+  // Producers and consumer indexes in different cache lines
+  #define BP_CHANNEL_ALIGN alignas(64)
+  #define BP_CHANNEL_MAX_LENGTH 16384
+#endif
+
+#if defined(__GNUC__) && !defined(__AVR__)
+  #define BP_CHANNEL_LOAD(P) __atomic_load_n(P, __ATOMIC_ACQUIRE)
+  #define BP_CHANNEL_STORE(P, V) __atomic_store_n(P, V, __ATOMIC_RELEASE)
+  #define BP_CHANNEL_CAS(P, E, V) __atomic_compare_exchange_n( \
+    P, &E, V, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED \
+  )
+#else // Single core, MPSC producers must not interrupt each other
+  #define BP_CHANNEL_LOAD(P) (*(volatile bp_channel_index_t *)(P))
+  #define BP_CHANNEL_STORE(P, V) (*(volatile bp_channel_index_t *)(P) = V)
+  #define BP_CHANNEL_CAS(P, E, V) \
+    ((BP_CHANNEL_LOAD(P) == E) ? (BP_CHANNEL_STORE(P, V), true) : false)
+#endif
+
+struct bp_channel_cell_t {
+  bp_channel_index_t sequence;
+  BP_VAR_TYPE value;
+};
+
+struct bp_channel_t {
+  bp_channel_cell_t *cells = NULL;
+  bp_channel_index_t mask = 0;
+  bool mpsc = false;
+  BP_CHANNEL_ALIGN bp_channel_index_t tail = 0; // Next cell to fill
+  BP_CHANNEL_ALIGN bp_channel_index_t head = 0; // Next cell to read
+};
+
+/* Distance of a sequence number from an index, both wrap around ------ */
+inline int32_t bp_channel_distance(bp_channel_index_t s, bp_channel_index_t i) {
+  return (bp_channel_distance_t)(bp_channel_index_t)(s - i);
+};
+
+/* INITIALIZE - false if length is not a power of two of at least 2 cells
+   or is too long (with a single cell its sequence number can't tell a
+   full cell from an empty one). */
+inline bool bp_channel_init(
+  bp_channel_t &c,
+  bp_channel_cell_t *cells,
+  uint16_t length,
+  bool mpsc = false
+) {
+  if((length < 2) || (length & (length - 1)))
+    return false;
+  if(length > BP_CHANNEL_MAX_LENGTH) return false;
+  for(uint16_t i = 0; i < length; i++) cells[i].sequence = i;
+  c.cells = cells;
+  c.mask = length - 1;
+  c.mpsc = mpsc;
+  c.head = c.tail = 0;
+  return true;
+};
+
+/* FULL - true if send would fail, seen by a producer -------------------- */
+inline bool bp_channel_full(bp_channel_t &c) {
+  bp_channel_index_t t = BP_CHANNEL_LOAD(&c.tail);
+  bp_channel_cell_t *cell = &c.cells[t & c.mask];
+  return bp_channel_distance(BP_CHANNEL_LOAD(&cell->sequence), t) < 0;
+};
+
+/* SEND - false if the channel is full ----------------------------------- */
+inline bool bp_channel_send(bp_channel_t &c, BP_VAR_TYPE v) {
+  bp_channel_index_t t = BP_CHANNEL_LOAD(&c.tail);
+  bp_channel_cell_t *cell;
+  for(;;) {
+    cell = &c.cells[t & c.mask];
+    int32_t d = bp_channel_distance(BP_CHANNEL_LOAD(&cell->sequence), t);
+    if(d < 0) return false;
+    if(!d) {
+      if(!c.mpsc) { BP_CHANNEL_STORE(&c.tail, t + 1); break; }
+      if(BP_CHANNEL_CAS(&c.tail, t, (bp_channel_index_t)(t + 1))) break;
+    } else t = BP_CHANNEL_LOAD(&c.tail); // Taken by another producer
+  }
+  cell->value = v;
+  BP_CHANNEL_STORE(&cell->sequence, t + 1);
+  return true;
+};
+
+/* RECEIVE - false if the channel is empty ------------------------------- */
+inline bool bp_channel_recv(bp_channel_t &c, BP_VAR_TYPE &v) {
+  bp_channel_index_t h = c.head;
+  bp_channel_cell_t *cell = &c.cells[h & c.mask];
+  if(bp_channel_distance(BP_CHANNEL_LOAD(&cell->sequence), h + 1) < 0)
+    return false;
+  v = cell->value;
+  BP_CHANNEL_STORE(&cell->sequence, h + c.mask + 1);
+  c.head = h + 1;
+  return true;
+};
@@ -0,0 +1,118 @@
+
+/* ______     ______           ______   _
+  |      | | |      | |              | | \    |
+  |_____/  | |______| |        ______| |  \   |
+  |     \  | |        |       |      | |   \  |
+  |______| | |        |______ |______| |    \_| CR.1
+  Byte coded Interpreted Programming Language
+  Giovanni Blu Mitolo 2017-2020 - gioscarab@gmail.com
+      _____              _________________________
+     |   | |            |_________________________|
+     |   | |_______________||__________   \___||_________ |
+   __|___|_|               ||          |__|   ||     |   ||
+  /________|_______________||_________________||__   |   |D
+    (O)                 |_________________________|__|___/|
+                                           \ /            |
+                                           (O)
+  BIPLAN Copyright (c) 2017-2020, Giovanni Blu Mitolo All rights reserved.
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License. */
+
+#pragma once
+#include "BIPLAN_Defines.h"
+
+/* BIP CONTAINER FORMAT ----------------------------------------------------
+   A precompiled BIP program and the indexes the interpreter would otherwise
+   compute scanning it. All fields are little-endian and unaligned:
+
+   HEADER                                                   BP_IMAGE_HEADER
+    0  'B' 'I' 'P' BP_IMAGE_VERSION
+    4  uint32 image length
+    8  uint32 body offset (from the start of the image)
+   12  uint32 body length (null terminator excluded)
+   16  uint16 variables, uint16 strings, uint16 functions used, uint16 0
+   24  uint32 function table entries
+   28  uint32 label table entries
+   32  uint32 block table entries
+   36  uint32 constant pool entries
+   40  uint32 string literal table entries
+   FUNCTION TABLE   uint16 id, uint32 address, uint8 n, n * uint16 param id
+   LABEL TABLE      uint16 variable id, uint32 address
+   BLOCK TABLE      uint32 opening code address, uint32 matching address
+   CONSTANT POOL    uint32 number address, int64 value
+   STRING TABLE     uint32 string address, uint16 length
+   BODY             BIP program, null terminated
+
+   Addresses are offsets from the start of the body. Blocks, constants and
+   strings are sorted by address. Blocks map if and else to where the
+   condition continues if false, for and while to their matching next.
+   String lengths above 65535 are saturated. */
+
+#define BP_IMAGE_VERSION        2
+#define BP_IMAGE_HEADER        44
+#define BP_IMAGE_LABEL_SIZE     6
+#define BP_IMAGE_BLOCK_SIZE     8
+#define BP_IMAGE_CONSTANT_SIZE 12
+#define BP_IMAGE_STRING_SIZE    6
+
+/* READ / WRITE LITTLE-ENDIAN FIELDS (images may be in flash) ------------- */
+
+uint8_t bp_image_read8(bp_image_t p) { return BPM_PROGRAM_READ(p); };
+
+uint16_t bp_image_read16(bp_image_t p) {
+  return (uint16_t)bp_image_read8(p) | ((uint16_t)bp_image_read8(p + 1) << 8);
+};
+
+uint32_t bp_image_read32(bp_image_t p) {
+  return
+    (uint32_t)bp_image_read16(p) | ((uint32_t)bp_image_read16(p + 2) << 16);
+};
+
+int64_t bp_image_read64(bp_image_t p) {
+  return (int64_t)(
+    (uint64_t)bp_image_read32(p) | ((uint64_t)bp_image_read32(p + 4) << 32)
+  );
+};
+
+void bp_image_write16(uint8_t *p, uint16_t v) {
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+};
+
+void bp_image_write32(uint8_t *p, uint32_t v) {
+  bp_image_write16(p, v & 0xFFFF);
+  bp_image_write16(p + 2, v >> 16);
+};
+
+void bp_image_write64(uint8_t *p, int64_t v) {
+  bp_image_write32(p, (uint64_t)v & 0xFFFFFFFF);
+  bp_image_write32(p + 4, (uint64_t)v >> 32);
+};
+
+/* FIND A SORTED TABLE ENTRY BY ADDRESS ----------------------------------- */
+
+bp_image_t bp_image_find(
+  bp_image_t table,
+  uint32_t entries,
+  uint8_t entry_size,
+  uint32_t address
+) {
+  uint32_t low = 0, high = entries;
+  while(low < high) {
+    uint32_t middle = low + ((high - low) >> 1);
+    bp_image_t e = table + ((uint32_t)middle * entry_size);
+    uint32_t a = bp_image_read32(e);
+    if(a == address) return e;
+    if(a < address) low = middle + 1;
+    else high = middle;
+  } return 0;
+};
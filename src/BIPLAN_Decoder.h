@@ -32,82 +32,118 @@
 #include <ctype.h>
 #include <stdlib.h>
 
-char    *decoder_ptr;
-char    *decoder_next_ptr;
-uint8_t  decoder_current = BP_ERROR;
+/* DECODER STATE ----------------------------------------------------------
+   Each interpreter has its own and points bp_decoder to it before running
+   (see decoder_own), so interpreters can take turns in the same thread or
+   run in parallel in different ones. */
+struct bp_decoder_state_t {
+  bp_code_t   ptr = 0;
+  bp_code_t   next_ptr = 0;
+  bp_code_t   last_ptr = 0;
+  uint8_t     current = BP_ERROR;
+};
+
+bp_decoder_state_t bp_decoder_default;
+BPM_DECODER_STORAGE bp_decoder_state_t *bp_decoder = &bp_decoder_default;
+
+/* READ A PROGRAM BYTE (the program may be in flash) ---------------------- */
+char decoder_read(bp_code_t p) { return BPM_PROGRAM_READ(p); };
 
 /* DECODER FINISHED ------------------------------------------------------- */
 uint8_t decoder_finished() {
-  return *decoder_ptr == 0 || decoder_current == BP_ENDOFINPUT;
+  return
+    decoder_read(bp_decoder->ptr) == 0 ||
+    bp_decoder->current == BP_ENDOFINPUT;
 };
 
 /* GET CURRENT CODE ------------------------------------------------------- */
-uint8_t decoder_get() { return decoder_current; };
+uint8_t decoder_get() { return bp_decoder->current; };
 
 /* DECODER POSITION ------------------------------------------------------- */
-char *decoder_position() { return decoder_ptr; };
+bp_code_t decoder_position() { return bp_decoder->ptr; };
+
+/* ID OF THE VARIABLE, STRING OR FUNCTION CODE AT p (see BP_EXTENDED) ---- */
+uint16_t decoder_id(bp_code_t p) {
+  uint8_t b = decoder_read(p + 1);
+  if(b < BP_EXTENDED) return b - BP_OFFSET;
+  return BP_SHORT_IDS + ((uint16_t)(b - BP_EXTENDED) << 7) +
+    ((uint8_t)decoder_read(p + 2) & 127);
+};
+
+/* ID OF THE PREVIOUS CODE ------------------------------------------------ */
+uint16_t decoder_last_id() { return decoder_id(bp_decoder->last_ptr); };
+
+/* POSITION AFTER THE VARIABLE, STRING OR FUNCTION CODE AT p -------------- */
+bp_code_t decoder_skip_id(bp_code_t p) {
+  return p + (((uint8_t)decoder_read(p + 1) >= BP_EXTENDED) ? 3 : 2);
+};
 
 /* GET NEXT CODE ---------------------------------------------------------- */
 uint8_t get_next_code() {
+  char c = decoder_read(bp_decoder->ptr);
   // if digit (0-9)
-  if(*decoder_ptr >= 48 && *decoder_ptr <= 57) {
-    for(uint8_t i = 0; i < BP_NUM_MAX_LENGTH; ++i)
-      if(decoder_ptr[i] < 48 || decoder_ptr[i] > 57) { // If not digit (0-9)
-        decoder_next_ptr = decoder_ptr + i;
+  if(c >= 48 && c <= 57) {
+    for(uint8_t i = 0; i < BP_NUM_MAX_LENGTH; ++i) {
+      c = decoder_read(bp_decoder->ptr + i);
+      if(c < 48 || c > 57) { // If not digit (0-9)
+        bp_decoder->next_ptr = bp_decoder->ptr + i;
         return BP_NUMBER;
       }
+    }
     return BP_ERROR;
   }
-  if(*decoder_ptr == BP_STRING) {
-    decoder_next_ptr = decoder_ptr;
+  if(c == BP_STRING) {
+    bp_decoder->next_ptr = bp_decoder->ptr;
     do {
-      ++decoder_next_ptr;
-    } while(*decoder_next_ptr != BP_STRING);
-    ++decoder_next_ptr;
+      ++bp_decoder->next_ptr;
+    } while(decoder_read(bp_decoder->next_ptr) != BP_STRING);
+    ++bp_decoder->next_ptr;
     return BP_STRING;
   }
   if(
-    *decoder_ptr == BP_ADDRESS ||
-    *decoder_ptr == BP_S_ADDRESS ||
-    *decoder_ptr == BP_FUNCTION
+    c == BP_ADDRESS ||
+    c == BP_S_ADDRESS ||
+    c == BP_FUNCTION ||
+    c == BP_FUN_DEF ||
+    c == BP_NATIVE
   ) {
-    decoder_next_ptr = decoder_ptr + 2;
-    return *decoder_ptr;
+    bp_decoder->next_ptr = decoder_skip_id(bp_decoder->ptr);
+    return c;
   }
-  if(*decoder_ptr > 0) {
-    decoder_next_ptr = decoder_ptr + 1;
-    return *decoder_ptr;
+  if(c > 0) {
+    bp_decoder->next_ptr = bp_decoder->ptr + 1;
+    return c;
   } else return BP_ENDOFINPUT;
   return BP_ERROR;
 };
 
 /* GET NEXT CODE ---------------------------------------------------------- */
 void decoder_next() {
-  decoder_ptr = decoder_next_ptr;
-  decoder_current = get_next_code();
+  bp_decoder->last_ptr = bp_decoder->ptr;
+  bp_decoder->ptr = bp_decoder->next_ptr;
+  bp_decoder->current = get_next_code();
 };
 
 /* MOVE DECODER TO A CERTAIN ZONE OF THE PROGRAM -------------------------- */
-void decoder_goto(char *program) {
-  decoder_ptr = program;
-  decoder_current = get_next_code();
+void decoder_goto(bp_code_t program) {
+  bp_decoder->ptr = program;
+  bp_decoder->current = get_next_code();
 };
 
 /* INITIALIZE DECODER ----------------------------------------------------- */
-void decoder_init(char *program) {
+void decoder_init(bp_code_t program) {
   decoder_goto(program);
-  decoder_current = get_next_code();
+  bp_decoder->current = get_next_code();
 };
 
 /* DECODE STRING ---------------------------------------------------------- */
 void decoder_string(char *d, uint16_t l) {
-  char *string_end;
-  uint16_t string_length;
-  if(decoder_current != BP_STRING) return;
-  string_end = strchr(decoder_ptr + 1, BP_STRING);
-  if(string_end == NULL) return;
-  string_length = string_end - decoder_ptr - 1;
-  if(l < string_length) string_length = l;
-  memcpy(d, decoder_ptr + 1, string_length);
-  d[string_length] = 0;
+  uint16_t string_length = 0;
+  char c;
+  if(bp_decoder->current != BP_STRING) return;
+  while(string_length < (l - 1)) {
+    c = decoder_read(bp_decoder->ptr + 1 + string_length);
+    if(c == BP_STRING || c == 0) break;
+    d[string_length++] = c;
+  } d[string_length] = 0;
 };
@@ -29,6 +29,8 @@
 
 #pragma once
 
+#include <stddef.h>
+#include <stdint.h>
 #include "utils/errors/BIPLAN_Errors.h"
 
 /* BYTE MEMORY SIZE ------------------------------------------------------- */
@@ -43,12 +45,184 @@
   #define BP_VAR_TYPE long
 #endif
 
+/* Unsigned type of the same size, BP_VAR_TYPE may be a typedef name
+   (int32_t for example) that can't be prefixed with unsigned. */
+template<uint8_t S> struct bp_unsigned_t { };
+template<> struct bp_unsigned_t<1> { typedef uint8_t type; };
+template<> struct bp_unsigned_t<2> { typedef uint16_t type; };
+template<> struct bp_unsigned_t<4> { typedef uint32_t type; };
+template<> struct bp_unsigned_t<8> { typedef uint64_t type; };
+
+#ifndef BP_UVAR_TYPE
+  #define BP_UVAR_TYPE bp_unsigned_t<sizeof(BP_VAR_TYPE)>::type
+#endif
+
 #ifndef BP_VAR_MAX
-  #define BP_VAR_MAX (BP_VAR_TYPE)((unsigned BP_VAR_TYPE) ~ 0 >> 1)
+  #define BP_VAR_MAX (BP_VAR_TYPE)((BP_UVAR_TYPE) ~ 0 >> 1)
 #endif
 
+/* EVENT - Source of a handler registered with on (see BP_EVENTS) -------
+   Interfaces arm pin and serial sources calling bp_event_signal from an
+   interrupt, a thread or the pin simulation, the interpreter checks
+   signaled at each statement and calls the handlers of pending events. */
+
+#define BP_EVENT_PIN    1
+#define BP_EVENT_SERIAL 2
+
+struct bp_event_t {
+  volatile bool pending = false;
+  volatile bool *signaled = NULL;
+  uint8_t type = 0; // 0 if free
+  bool polled = false; // Not armed by the interface, checked by polling
+  BP_VAR_TYPE source = 0; // Pin number
+  BP_VAR_TYPE last = 0; // Last state of a polled pin
+  uint16_t fun = 0;
+};
+
+inline void bp_event_set(volatile bool &f) {
+  #if defined(__GNUC__) && !defined(__AVR__)
+    __atomic_store_n(&f, true, __ATOMIC_RELEASE);
+  #else
+    f = true;
+  #endif
+};
+
+inline bool bp_event_take(volatile bool &f) { // Read and clear
+  #if defined(__GNUC__) && !defined(__AVR__)
+    return __atomic_exchange_n(&f, false, __ATOMIC_ACQUIRE);
+  #else
+    if(!f) return false;
+    f = false;
+    return true;
+  #endif
+};
+
+inline void bp_event_signal(bp_event_t *e) {
+  bp_event_set(e->pending); // Seen before signaled by other cores
+  bp_event_set(*e->signaled);
+};
+
 #include "interfaces/BIPLAN_Interfaces.h"
 
+/* MEMORY FENCE - Orders the accesses to host mapped regions -------------
+   Used only if BP_MEM_REGIONS is defined, see map_memory. */
+
+#ifndef BPM_MEM_FENCE
+  #if defined(__GNUC__) && !defined(__AVR__)
+    #define BPM_MEM_FENCE() __sync_synchronize()
+  #else
+    #define BPM_MEM_FENCE()
+  #endif
+#endif
+
+/* DECODER STORAGE - Storage class of the decoder state ----------------
+   On hosts each thread has its own, so interpreters can run in parallel
+   in different threads. */
+
+#ifndef BPM_DECODER_STORAGE
+  #if defined(__linux__) || defined(_WIN32) || defined(__APPLE__)
+    #define BPM_DECODER_STORAGE thread_local
+  #else
+    #define BPM_DECODER_STORAGE
+  #endif
+#endif
+
+/* EVENT SOURCES - Arm pins and serial ports to signal an event ---------
+   Return true if armed, otherwise the source is polled at each statement
+   with BPM_IO_READ or BPM_SERIAL_AVAILABLE. */
+
+#ifndef BPM_EVENT_PIN
+  #define BPM_EVENT_PIN(E, P) false
+#endif
+
+#ifndef BPM_EVENT_SERIAL
+  #define BPM_EVENT_SERIAL(E, S) false
+#endif
+
+/* CHANNEL WAIT - Called while send or recv wait within a function ----
+   Interfaces of multi-threaded hosts yield the processor. */
+
+#ifndef BPM_CHANNEL_WAIT
+  #define BPM_CHANNEL_WAIT()
+#endif
+
+/* STRING TO NUMBER - Interfaces may use the host conversion -------------
+   By default bp_atol (see BIPLAN_Number.h) is used. */
+
+#ifndef BPM_ATOL
+  #define BPM_ATOL bp_atol
+#endif
+
+/* SQUARE ROOT - Interfaces with a floating point unit use bp_fsqrt -------
+   By default the integer bp_isqrt (see BIPLAN_Number.h) is used. */
+
+#ifndef BPM_SQRT
+  #define BPM_SQRT bp_isqrt
+#endif
+
+/* BURST SAMPLING - Interfaces may sample analog pins natively ------------
+   Reads N samples of pin P in the buffer D of elements of B bytes (stored
+   little-endian), waiting I microseconds between samples. */
+
+#ifndef BPM_AREAD_BURST
+  #define BPM_AREAD_BURST(P, D, B, N, I) do { \
+    uint32_t bp_t = BPM_MICROS(); \
+    for(uint32_t bp_i = 0; bp_i < (N); bp_i++) { \
+      if(bp_i) { \
+        while((uint32_t)(BPM_MICROS() - bp_t) < (I)); \
+        bp_t += (I); \
+      } \
+      uint32_t bp_v = BPM_AREAD(P); \
+      for(uint8_t bp_b = 0; bp_b < (B); bp_b++, bp_v >>= 8) \
+        (D)[(bp_i * (B)) + bp_b] = bp_v; \
+    } \
+  } while(0)
+#endif
+
+/* SERIAL BULK TRANSMISSION - Interfaces may send a buffer at once --------
+   Transmits L bytes starting from P. */
+
+#ifndef BPM_SERIAL_WRITE_BUF
+  #define BPM_SERIAL_WRITE_BUF(S, P, L) do { \
+    for(uint16_t bp_i = 0; bp_i < (L); bp_i++) { \
+      uint8_t bp_c = (P)[bp_i]; \
+      BPM_SERIAL_WRITE(S, bp_c); \
+    } \
+  } while(0)
+#endif
+
+/* PRINT FLUSH - Interfaces may flush the buffers of the host stream -----
+   Called by print_flush before delay, input and serialRead, at restart
+   and end of the program. */
+
+#ifndef BPM_PRINT_FLUSH
+  #define BPM_PRINT_FLUSH(S)
+#endif
+
+/* PAGED PROGRAM MEMORY - Read programs larger than RAM from storage ------ */
+
+#ifdef BP_PAGED
+  #include "BIPLAN_Pager.h"
+  #define BPM_PROGRAM_READ(P) bp_pager_read(*bp_pager, P)
+#endif
+
+/* PROGRAM POSITIONS - Where codes are in the program or in the container -
+   Pointers, or offsets from the start of storage if BP_PAGED. */
+
+#ifdef BP_PAGED
+  typedef uint32_t bp_code_t;
+  typedef uint32_t bp_image_t;
+#else
+  typedef const char *bp_code_t;
+  typedef const uint8_t *bp_image_t;
+#endif
+
+/* PROGRAM MEMORY READ - Interfaces may read programs stored in flash ----- */
+
+#ifndef BPM_PROGRAM_READ
+  #define BPM_PROGRAM_READ(P) (*(P))
+#endif
+
 /* KEYWORD MAXIMUM LENGTH ------------------------------------------------- */
 
 #ifndef BP_MAX_KEYWORD_LENGTH
@@ -61,19 +235,30 @@
   #define BP_OFFSET 35
 #endif
 
-/* VARIABLES AMOUNT - Higher if required (MAX 92) ------------------------- */
+/* EXTENDED ADDRESSING ----------------------------------------------------
+   The first BP_SHORT_IDS variables, strings and functions are encoded in a
+   single byte (id + BP_OFFSET), the following in two bytes:
+   BP_EXTENDED + ((id - BP_SHORT_IDS) / 128), 128 + ((id - BP_SHORT_IDS) % 128)
+   BCC gives two bytes ids to the longest names, programs using less than
+   BP_SHORT_IDS names are encoded as before. */
+
+#define BP_SHORT_IDS 92
+#define BP_EXTENDED 220
+#define BP_MAX_IDS (BP_SHORT_IDS + ((256 - BP_EXTENDED) * 128))
+
+/* VARIABLES AMOUNT - Higher if required (MAX BP_MAX_IDS) ----------------- */
 
 #ifndef BP_VARIABLES
   #define BP_VARIABLES 50
 #endif
 
-/* STRINGS AMOUNT - Higher if required (MAX 92) --------------------------- */
+/* STRINGS AMOUNT - Higher if required (MAX BP_MAX_IDS) ------------------- */
 
 #ifndef BP_STRINGS
   #define BP_STRINGS 20
 #endif
 
-/* FUNCTIONS AMOUNT - Higher if required (MAX 92) ------------------------- */
+/* FUNCTIONS AMOUNT - Higher if required (MAX BP_MAX_IDS) ----------------- */
 
 #ifndef BP_MAX_FUNCTIONS
   #define BP_MAX_FUNCTIONS 20
@@ -91,6 +276,13 @@
   #define BP_FUN_DEPTH 20
 #endif
 
+/* RANDOM SEED - Initial state of the generator of each interpreter ------
+   Used if the interface does not define BPM_RANDOM (see random_seed). */
+
+#ifndef BP_RANDOM_SEED
+  #define BP_RANDOM_SEED 2463534242UL
+#endif
+
 /* MAXIMUM LENGTH OF NUMBER ----------------------------------------------- */
 
 #ifndef BP_NUM_MAX_LENGTH
@@ -103,12 +295,83 @@
   #define BP_STRING_MAX_LENGTH 60
 #endif
 
+/* PRINT BUFFER - Collect the output of print before writing it ----------
+   By default each item printed is written with BPM_PRINT_WRITE. Defining
+   BP_PRINT_BUFFER numbers are converted internally and the output is
+   collected in a buffer of that many bytes, written when full, before
+   delay, input and serialRead, at restart and end of the program and as
+   selected by BP_PRINT_FLUSH_POLICY:
+   BP_FLUSH_LINE  - Also at each new line (default)
+   BP_FLUSH_PRINT - Also at the end of each print
+   BP_FLUSH_FULL  - Only in the cases listed above
+   #define BP_PRINT_BUFFER 64 */
+
+#define BP_FLUSH_FULL  0
+#define BP_FLUSH_LINE  1
+#define BP_FLUSH_PRINT 2
+
+#if defined(BP_PRINT_BUFFER) && !defined(BP_PRINT_FLUSH_POLICY)
+  #define BP_PRINT_FLUSH_POLICY BP_FLUSH_LINE
+#endif
+
+/* PRINTF - Maximum length of the text rendered in one write ------------- */
+
+#ifndef BP_PRINTF_MAX_LENGTH
+  #define BP_PRINTF_MAX_LENGTH 80
+#endif
+
+/* PRINTF FORMATS - Compiled by BCC in segments ---------------------------
+   Each placeholder (%d, %x, %c, %s) is encoded in two bytes, its type and
+   its width + 1, plus BP_FMT_ZERO if padded with zeros (%05d). */
+
+#define BP_FMT_NUMBER        2
+#define BP_FMT_HEX           3
+#define BP_FMT_CHAR          4
+#define BP_FMT_STRING        5
+#define BP_FMT_ZERO         64
+#define BP_FMT_MAX_WIDTH    32
+
+/* STRING ARENA - Share a budget of bytes among all strings ---------------
+   By default each string reserves BP_STRING_MAX_LENGTH bytes. Defining
+   BP_STRING_ARENA strings are stored in an arena of that many bytes, each
+   one takes the space it needs rounded to BP_STRING_ARENA_STEP bytes and
+   grows on demand (up to BP_STRING_MAX_LENGTH - 1 characters). Lengths
+   are tracked, so length, copy and print cost as much as the string.
+   #define BP_STRING_ARENA 512 */
+
+#if defined(BP_STRING_ARENA) && !defined(BP_STRING_ARENA_STEP)
+  #define BP_STRING_ARENA_STEP 8
+#endif
+
 /* FOR MAXIMUM DEPTH - Higher if required --------------------------------- */
 
 #ifndef BP_CYCLE_DEPTH
   #define BP_CYCLE_DEPTH 20
 #endif
 
+/* UNCHECKED ACCESS ------------------------------------------------------
+   Programs are verified when the interpreter is initialized. Defining
+   BP_UNCHECKED removes the bound checks of statically verified variable,
+   string and function ids, dynamic indexes ($[], :[], @[], jump) are
+   clamped to the buffer bounds without raising an error.
+   #define BP_UNCHECKED */
+
+/* EVENTS - Handlers of pin changes and serial data ----------------------
+   Defining BP_EVENTS programs can register up to that many handlers with
+   on pin and on serial, called between statements when an event occurs.
+   #define BP_EVENTS 4 */
+
+/* TIMERS - Periodic calls ----------------------------------------------
+   Defining BP_TIMERS programs can register up to that many functions
+   with every, called between statements each period of milliseconds.
+   #define BP_TIMERS 4 */
+
+/* CHANNELS - Message passing among interpreters --------------------------
+   Defining BP_CHANNELS each interpreter can have that many channels
+   attached by the host (see attach_channel and BIPLAN_Channel.h), used by
+   send, recv and tryrecv. Without it channel calls raise an error.
+   #define BP_CHANNELS 4 */
+
 /* MACHINE AND HUMAN-READABLE LANGUAGE SYNTAX -----------------------------
 _______________________________________________________________________
  CONSTANT NAME                                    | DECIMAL     | USED |
@@ -119,28 +382,64 @@ __________________________________________________|_____________|______| */
                                                   //  3         |      |
                                                   //  4         |      |
                                                   //  5         |      |
-                                                  //  6         |      |
-                                                  //  7         |      |
-                                                  //  8         |      |
+//______________________________________________________________|______|
+#define BP_SEND               6                   //  6         | USED |
+#define BP_SEND_HUMAN        "send"               //            |      |
+//______________________________________________________________|______|
+#define BP_RECV               7                   //  7         | USED |
+#define BP_RECV_HUMAN        "recv"               //            |      |
+//______________________________________________________________|______|
+#define BP_TRYRECV            8                   //  8         | USED |
+#define BP_TRYRECV_HUMAN     "tryrecv"            //            |      |
+//______________________________________________________________|______|
                                                   //  9         |      |
                                                   // 10         |      |
                                                   // 11         |      |
                                                   // 12         |      |
 #define BP_CR               '\n'                  // 13         |      |
-                                                  // 14         |      |
-                                                  // 15         |      |
-                                                  // 16         |      |
-                                                  // 17         |      |
-                                                  // 18         |      |
-                                                  // 19         |      |
-                                                  // 20         |      |
-                                                  // 21         |      |
-                                                  // 22         |      |
-                                                  // 23         |      |
-                                                  // 24         |      |
-                                                  // 25         |      |
-                                                  // 26         |      |
-                                                  // 27         |      |
+//______________________________________________________________|______|
+#define BP_MEMFILL           14                   // 14         | USED |
+#define BP_MEMFILL_HUMAN     "memfill"            //            |      |
+//______________________________________________________________|______|
+#define BP_MEMCOPY           15                   // 15         | USED |
+#define BP_MEMCOPY_HUMAN     "memcopy"            //            |      |
+//______________________________________________________________|______|
+#define BP_MEMSUM            16                   // 16         | USED |
+#define BP_MEMSUM_HUMAN      "memsum"             //            |      |
+//______________________________________________________________|______|
+#define BP_MEMMINMAX         17                   // 17         | USED |
+#define BP_MEMMINMAX_HUMAN   "memminmax"          //            |      |
+//______________________________________________________________|______|
+#define BP_MEMSCALE          18                   // 18         | USED |
+#define BP_MEMSCALE_HUMAN    "memscale"           //            |      |
+//______________________________________________________________|______|
+#define BP_MEMDOT            19                   // 19         | USED |
+#define BP_MEMDOT_HUMAN      "memdot"             //            |      |
+//______________________________________________________________|______|
+#define BP_ABURST            20                   // 20         | USED |
+#define BP_ABURST_HUMAN      "analogBurst"        //            |      |
+//______________________________________________________________|______|
+#define BP_PINS_WRITE        21                   // 21         | USED |
+#define BP_PINS_WRITE_HUMAN  "pinsWrite"          //            |      |
+//______________________________________________________________|______|
+#define BP_PINS_READ         22                   // 22         | USED |
+#define BP_PINS_READ_HUMAN   "pinsRead"           //            |      |
+//______________________________________________________________|______|
+#define BP_SHIFT_OUT         23                   // 23         | USED |
+#define BP_SHIFT_OUT_HUMAN   "shiftOut"           //            |      |
+//______________________________________________________________|______|
+#define BP_STRCMP            24                   // 24         | USED |
+#define BP_STRCMP_HUMAN      "strcmp"             //            |      |
+//______________________________________________________________|______|
+#define BP_STRFIND           25                   // 25         | USED |
+#define BP_STRFIND_HUMAN     "strfind"            //            |      |
+//______________________________________________________________|______|
+#define BP_STRCAT            26                   // 26         | USED |
+#define BP_STRCAT_HUMAN      "strcat"             //            |      |
+//______________________________________________________________|______|
+#define BP_SUBSTR            27                   // 27         | USED |
+#define BP_SUBSTR_HUMAN      "substr"             //            |      |
+//______________________________________________________________|______|
                                                   // 28         |      |
                                                   // 29         |      |
                                                   // 30         |      |
@@ -276,10 +575,18 @@ __________________________________________________|_____________|______| */
 #define BP_VAR_ACCESS        'V'                  // 86         | USED |
 #define BP_VAR_ACCESS_HUMAN  "$["                 //            |      |
 //______________________________________________________________|______|
-                           // W                   // 87         |      |
-                           // X                   // 88         |      |
-                           // Y                   // 89         |      |
-                           // Z                   // 90         |      |
+#define BP_MEM_VIEW          'W'                  // 87         | USED |
+#define BP_MEM_VIEW_HUMAN    "@"                  //            |      |
+//______________________________________________________________|______|
+#define BP_MEM_SVIEW         'X'                  // 88         | USED |
+#define BP_MEM_SVIEW_HUMAN   "@s"                 //            |      |
+//______________________________________________________________|______|
+#define BP_ON                'Y'                  // 89         | USED |
+#define BP_ON_HUMAN          "on"                 //            |      |
+// on pin 3 call f -> YZ3,~#                      //            |      |
+//______________________________________________________________|______|
+#define BP_PIN               'Z'                  // 90         | USED |
+#define BP_PIN_HUMAN         "pin"                //            |      |
 //______________________________________________________________|______|
 #define BP_ACCESS            '['                  // 91         | USED |
 //______________________________________________________________|______|
@@ -322,7 +629,8 @@ __________________________________________________|_____________|______| */
 #define BP_JUMP              'j'                  // 106        | USED |
 #define BP_JUMP_HUMAN        "jump"               //            |      |
 //______________________________________________________________|______|
-                           // k                   // 107        |      |
+#define BP_SERIAL            'k'                  // 107        | USED |
+#define BP_SERIAL_HUMAN      "serial"             //            |      |
 //______________________________________________________________|______|
 #define BP_LABEL             'l'                  // 108        | USED |
 #define BP_LABEL_HUMAN       "label"              //            |      |
@@ -333,7 +641,8 @@ __________________________________________________|_____________|______| */
 #define BP_NEXT              'n'                  // 110        | USED |
 #define BP_NEXT_HUMAN        "next"               //            |      |
 //______________________________________________________________|______|
-                           // o                   // 111        |      |
+#define BP_PRINTF            'o'                  // 111        | USED |
+#define BP_PRINTF_HUMAN      "printf"             //            |      |
 //______________________________________________________________|______|
 #define BP_PRINT             'p'                  // 112        | USED |
 #define BP_PRINT_HUMAN       "print"              //            |      |
@@ -352,7 +661,9 @@ __________________________________________________|_____________|______| */
 #define BP_SERIAL_RX         'u'                  // 117        | USED |
 #define BP_SERIAL_RX_HUMAN   "serialRead"         //            |      |
 //______________________________________________________________|______|
-                          // 'v'                  // 118        |      |
+#define BP_EVERY             'v'                  // 118        | USED |
+#define BP_EVERY_HUMAN       "every"              //            |      |
+// every 100 call f -> v100,~#                    //            |      |
 //______________________________________________________________|______|
 #define BP_WHILE             'w'                  // 119        | USED |
 #define BP_WHILE_HUMAN       "while"              //            |      |
@@ -369,7 +680,8 @@ __________________________________________________|_____________|______| */
 //______________________________________________________________|______|
 #define BP_OR                '|'                  // 124        | USED |
 //______________________________________________________________|______|
-                           // }                   // 125        |      |
+#define BP_NATIVE            '}'                  // 125        | USED |
+// led(13, 1) -> }0(13, 1)                        //            |      |
 //______________________________________________________________|______|
 #define BP_FUNCTION          '~'                  // 126        | USED |
 // sum(2 + 2) -> ~0(2 + 2)                        //            |      |
@@ -392,3 +704,23 @@ __________________________________________________|_____________|______| */
 /* DATA TYPES ------------------------------------------------------------- */
 
 typedef void (*error_type)(char *position, const char *string);
+
+/* Native function bound by the host, called with params arguments */
+typedef BP_VAR_TYPE (*bp_native_fun_t)(BP_VAR_TYPE *args);
+
+struct bp_native_t {
+  const char *name;
+  bp_native_fun_t fun;
+  uint8_t params;
+};
+
+/* Periodic call registered with every, times in milliseconds */
+struct bp_timer_t {
+  uint32_t period = 0; // 0 if free
+  uint32_t next = 0; // Deadline of the next call
+  uint16_t fun = 0;
+  uint32_t runs = 0;
+  uint32_t overruns = 0; // Periods skipped, the call was too late
+  uint32_t jitter_max = 0; // Delay of a call after its deadline
+  uint32_t jitter_sum = 0;
+};
@@ -0,0 +1,394 @@
+
+/* ______     ______           ______   _
+  |      | | |      | |              | | \    |
+  |_____/  | |______| |        ______| |  \   |
+  |     \  | |        |       |      | |   \  |
+  |______| | |        |______ |______| |    \_| CR.1
+  Byte coded Interpreted Programming Language
+  Giovanni Blu Mitolo 2017-2020 - gioscarab@gmail.com
+      _____              _________________________
+     |   | |            |_________________________|
+     |   | |_______________||__________   \___||_________ |
+   __|___|_|               ||          |__|   ||     |   ||
+  /________|_______________||_________________||__   |   |D
+    (O)                 |_________________________|__|___/|
+                                           \ /            |
+                                           (O)
+  BIPLAN Copyright (c) 2017-2020, Giovanni Blu Mitolo All rights reserved.
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License. */
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+/* BULK MEMORY KERNELS ----------------------------------------------------
+   Operations on ranges of the interpreter memory seen as arrays of 8, 16,
+   32 or 64 bits signed or unsigned elements (see BP_MEM_VIEW). Elements
+   are stored little-endian at any alignment. The scalar kernels assemble
+   elements byte by byte and run on any architecture, on x86-64 8 and 16
+   bits elements are processed with SSE2 or, if compiled with -mavx2, AVX2.
+   Define BP_MEM_SCALAR to use only the scalar kernels. */
+
+struct bp_mem_view_t {
+  uint8_t *data;
+  uint8_t bytes;
+  bool sign;
+};
+
+/* HOST MAPPED REGION (see BIPLAN_Interpreter::map_memory) ---------------
+   length bytes at data, seen by the program from @[address]. notify is
+   called with the offset and the length of each range the program writes
+   in the region. */
+typedef void (*bp_mem_notify_t)(uint8_t region, uint32_t offset, uint32_t l);
+
+struct bp_mem_region_t {
+  uint8_t *data;
+  uint32_t address;
+  uint32_t length;
+  bp_mem_notify_t notify;
+  bool fence;
+};
+
+#if !defined(BP_MEM_SCALAR) && (defined(__x86_64__) || defined(_M_X64))
+  #include <immintrin.h>
+  #define BP_MEM_SIMD
+  #if defined(__AVX2__)
+    typedef __m256i bp_vec_t;
+    #define BP_VEC_SIZE 32
+    #define BP_VEC(F) _mm256_##F
+    #define BP_VEC_SI(F) _mm256_##F##_si256
+  #else
+    typedef __m128i bp_vec_t;
+    #define BP_VEC_SIZE 16
+    #define BP_VEC(F) _mm_##F
+    #define BP_VEC_SI(F) _mm_##F##_si128
+  #endif
+  #define bp_vec_load(P) BP_VEC_SI(loadu)((const bp_vec_t *)(P))
+  #define bp_vec_store(P, V) BP_VEC_SI(storeu)((bp_vec_t *)(P), V)
+#endif
+
+/* ELEMENT ACCESS --------------------------------------------------------- */
+
+int64_t bp_mem_load(const uint8_t *p, uint8_t bytes, bool sign) {
+  uint64_t v = 0;
+  for(uint8_t i = bytes; i; i--) v = (v << 8) | p[i - 1];
+  if(sign && (bytes < 8) && ((v >> ((bytes * 8) - 1)) & 1))
+    v |= ~(uint64_t)0 << (bytes * 8);
+  return (int64_t)v;
+};
+
+void bp_mem_store(uint8_t *p, uint8_t bytes, int64_t value) {
+  uint64_t v = (uint64_t)value;
+  for(uint8_t i = 0; i < bytes; i++, v >>= 8) p[i] = v & 0xFF;
+};
+
+/* Saturate a value to the range of an element ---------------------------- */
+int64_t bp_mem_clamp(int64_t v, uint8_t bytes, bool sign) {
+  if(bytes >= 8) return v;
+  int64_t max = ((int64_t)1 << ((bytes * 8) - sign)) - 1;
+  int64_t min = (sign) ? -max - 1 : 0;
+  return (v < min) ? min : (v > max) ? max : v;
+};
+
+#ifdef BP_MEM_SIMD
+
+/* Sign extend 32 bits lanes and add them to a 64 bits accumulator ------- */
+bp_vec_t bp_vec_add32(bp_vec_t acc, bp_vec_t v) {
+  bp_vec_t s = BP_VEC(srai_epi32)(v, 31);
+  acc = BP_VEC(add_epi64)(acc, BP_VEC(unpacklo_epi32)(v, s));
+  return BP_VEC(add_epi64)(acc, BP_VEC(unpackhi_epi32)(v, s));
+};
+
+int64_t bp_vec_sum64(bp_vec_t v) {
+  int64_t l[BP_VEC_SIZE / 8], r = 0;
+  bp_vec_store(l, v);
+  for(uint8_t i = 0; i < (BP_VEC_SIZE / 8); i++) r += l[i];
+  return r;
+};
+
+/* 8 and 16 bits elements, n is reduced to the elements left to process -- */
+
+int64_t bp_vec_sum(bp_mem_view_t v, uint32_t &n) {
+  const uint8_t *p = v.data;
+  uint32_t c = (n / (BP_VEC_SIZE / v.bytes)) * (BP_VEC_SIZE / v.bytes);
+  bp_vec_t acc = BP_VEC_SI(setzero)(), zero = BP_VEC_SI(setzero)();
+  int64_t bias = 0;
+  if(v.bytes == 1) {
+    bp_vec_t flip = BP_VEC(set1_epi8)((char)0x80);
+    for(uint32_t i = 0; i < c; i += BP_VEC_SIZE, p += BP_VEC_SIZE) {
+      bp_vec_t x = bp_vec_load(p);
+      if(v.sign) x = BP_VEC_SI(xor)(x, flip); // x + 128 as unsigned
+      acc = BP_VEC(add_epi64)(acc, BP_VEC(sad_epu8)(x, zero));
+    }
+    if(v.sign) bias = -128 * (int64_t)c;
+  } else {
+    bp_vec_t flip = BP_VEC(set1_epi16)((short)0x8000);
+    bp_vec_t ones = BP_VEC(set1_epi16)(1);
+    for(uint32_t i = 0; i < c; i += BP_VEC_SIZE / 2, p += BP_VEC_SIZE) {
+      bp_vec_t x = bp_vec_load(p);
+      if(!v.sign) x = BP_VEC_SI(xor)(x, flip); // x - 32768 as signed
+      acc = bp_vec_add32(acc, BP_VEC(madd_epi16)(x, ones));
+    }
+    if(!v.sign) bias = 32768 * (int64_t)c;
+  }
+  n -= c;
+  return bp_vec_sum64(acc) + bias;
+};
+
+void bp_vec_minmax(
+  bp_mem_view_t v,
+  uint32_t &n,
+  int64_t &min,
+  int64_t &max
+) {
+  const uint8_t *p = v.data;
+  uint32_t c = (n / (BP_VEC_SIZE / v.bytes)) * (BP_VEC_SIZE / v.bytes);
+  if(!c) return;
+  bp_vec_t flip = (v.bytes == 1) ?
+    BP_VEC(set1_epi8)((char)((v.sign) ? 0x80 : 0)) :
+    BP_VEC(set1_epi16)((short)((v.sign) ? 0 : 0x8000));
+  bp_vec_t lo = BP_VEC_SI(xor)(bp_vec_load(p), flip), hi = lo;
+  for(uint32_t i = 0; i < c; i += BP_VEC_SIZE / v.bytes, p += BP_VEC_SIZE) {
+    bp_vec_t x = BP_VEC_SI(xor)(bp_vec_load(p), flip);
+    if(v.bytes == 1) { // Signed bytes flipped to unsigned
+      lo = BP_VEC(min_epu8)(lo, x);
+      hi = BP_VEC(max_epu8)(hi, x);
+    } else { // Unsigned 16 bits flipped to signed
+      lo = BP_VEC(min_epi16)(lo, x);
+      hi = BP_VEC(max_epi16)(hi, x);
+    }
+  }
+  uint8_t l[BP_VEC_SIZE], h[BP_VEC_SIZE];
+  bp_vec_store(l, BP_VEC_SI(xor)(lo, flip));
+  bp_vec_store(h, BP_VEC_SI(xor)(hi, flip));
+  for(uint8_t i = 0; i < BP_VEC_SIZE; i += v.bytes) {
+    int64_t a = bp_mem_load(l + i, v.bytes, v.sign);
+    int64_t b = bp_mem_load(h + i, v.bytes, v.sign);
+    if(a < min) min = a;
+    if(b > max) max = b;
+  }
+  n -= c;
+};
+
+int64_t bp_vec_dot(bp_mem_view_t a, bp_mem_view_t b, uint32_t &n) {
+  const uint8_t *p = a.data, *q = b.data;
+  uint32_t c = (n / (BP_VEC_SIZE / a.bytes)) * (BP_VEC_SIZE / a.bytes);
+  bp_vec_t acc = BP_VEC_SI(setzero)(), zero = BP_VEC_SI(setzero)();
+  for(uint32_t i = 0; i < c; i += BP_VEC_SIZE / a.bytes) {
+    bp_vec_t x = bp_vec_load(p), y = bp_vec_load(q);
+    p += BP_VEC_SIZE;
+    q += BP_VEC_SIZE;
+    if(a.bytes == 1) { // Extend to 16 bits, products pairs fit 32 bits
+      bp_vec_t sx = (a.sign) ? BP_VEC(cmpgt_epi8)(zero, x) : zero;
+      bp_vec_t sy = (a.sign) ? BP_VEC(cmpgt_epi8)(zero, y) : zero;
+      bp_vec_t l = BP_VEC(madd_epi16)(
+        BP_VEC(unpacklo_epi8)(x, sx), BP_VEC(unpacklo_epi8)(y, sy)
+      );
+      bp_vec_t h = BP_VEC(madd_epi16)(
+        BP_VEC(unpackhi_epi8)(x, sx), BP_VEC(unpackhi_epi8)(y, sy)
+      );
+      acc = bp_vec_add32(acc, BP_VEC(add_epi32)(l, h));
+    } else { // Exact 32 bits products from their low and high halves
+      bp_vec_t l = BP_VEC(mullo_epi16)(x, y);
+      bp_vec_t h = (a.sign) ?
+        BP_VEC(mulhi_epi16)(x, y) : BP_VEC(mulhi_epu16)(x, y);
+      bp_vec_t p0 = BP_VEC(unpacklo_epi16)(l, h);
+      bp_vec_t p1 = BP_VEC(unpackhi_epi16)(l, h);
+      if(a.sign) {
+        acc = bp_vec_add32(acc, p0);
+        acc = bp_vec_add32(acc, p1);
+      } else {
+        acc = BP_VEC(add_epi64)(acc, BP_VEC(unpacklo_epi32)(p0, zero));
+        acc = BP_VEC(add_epi64)(acc, BP_VEC(unpackhi_epi32)(p0, zero));
+        acc = BP_VEC(add_epi64)(acc, BP_VEC(unpacklo_epi32)(p1, zero));
+        acc = BP_VEC(add_epi64)(acc, BP_VEC(unpackhi_epi32)(p1, zero));
+      }
+    }
+  }
+  n -= c;
+  return bp_vec_sum64(acc);
+};
+
+/* Signed 16 bits elements scaled by a 16 bits factor, saturated --------- */
+void bp_vec_scale(bp_mem_view_t v, uint32_t &n, int16_t mul, uint8_t shift) {
+  uint8_t *p = v.data;
+  uint32_t c = (n / (BP_VEC_SIZE / 2)) * (BP_VEC_SIZE / 2);
+  bp_vec_t m = BP_VEC(set1_epi16)(mul);
+  __m128i s = _mm_cvtsi32_si128((shift > 31) ? 31 : shift);
+  for(uint32_t i = 0; i < c; i += BP_VEC_SIZE / 2, p += BP_VEC_SIZE) {
+    bp_vec_t x = bp_vec_load(p);
+    bp_vec_t l = BP_VEC(mullo_epi16)(x, m), h = BP_VEC(mulhi_epi16)(x, m);
+    bp_vec_t p0 = BP_VEC(sra_epi32)(BP_VEC(unpacklo_epi16)(l, h), s);
+    bp_vec_t p1 = BP_VEC(sra_epi32)(BP_VEC(unpackhi_epi16)(l, h), s);
+    bp_vec_store(p, BP_VEC(packs_epi32)(p0, p1));
+  }
+  n -= c;
+};
+
+#endif
+
+/* FILL n elements with a value ------------------------------------------- */
+void bp_mem_fill(bp_mem_view_t v, uint32_t n, int64_t value) {
+  if(v.bytes == 1) return (void)memset(v.data, (uint8_t)value, n);
+  uint8_t *p = v.data;
+  #ifdef BP_MEM_SIMD
+    uint8_t e[BP_VEC_SIZE];
+    for(uint8_t i = 0; i < BP_VEC_SIZE; i += v.bytes)
+      bp_mem_store(e + i, v.bytes, value);
+    bp_vec_t x = bp_vec_load(e);
+    for(; n >= (uint32_t)(BP_VEC_SIZE / v.bytes); n -= BP_VEC_SIZE / v.bytes) {
+      bp_vec_store(p, x);
+      p += BP_VEC_SIZE;
+    }
+  #endif
+  for(; n; n--, p += v.bytes) bp_mem_store(p, v.bytes, value);
+};
+
+/* COPY n elements, converted if the views have different types ----------- */
+void bp_mem_copy(bp_mem_view_t d, bp_mem_view_t s, uint32_t n) {
+  if(d.bytes == s.bytes) return (void)memmove(d.data, s.data, n * d.bytes);
+  if(d.data <= s.data) // Overlapping ranges are copied in address order
+    for(uint32_t i = 0; i < n; i++)
+      bp_mem_store(
+        d.data + (i * d.bytes), d.bytes,
+        bp_mem_load(s.data + (i * s.bytes), s.bytes, s.sign)
+      );
+  else
+    for(uint32_t i = n; i; i--)
+      bp_mem_store(
+        d.data + ((i - 1) * d.bytes), d.bytes,
+        bp_mem_load(s.data + ((i - 1) * s.bytes), s.bytes, s.sign)
+      );
+};
+
+/* SUM of n elements (64 bits elements wrap around) ----------------------- */
+int64_t bp_mem_sum(bp_mem_view_t v, uint32_t n) {
+  uint64_t r = 0;
+  #ifdef BP_MEM_SIMD
+    if(v.bytes <= 2) {
+      uint32_t t = n;
+      r = bp_vec_sum(v, t);
+      v.data += (n - t) * v.bytes;
+      n = t;
+    }
+  #endif
+  if((v.bytes == 1) && !v.sign) for(; n; n--) r += *(v.data++);
+  else
+    for(; n; n--, v.data += v.bytes) r += bp_mem_load(v.data, v.bytes, v.sign);
+  return (int64_t)r;
+};
+
+/* MINIMUM AND MAXIMUM of n elements (0 if n is 0) ------------------------ */
+void bp_mem_minmax(bp_mem_view_t v, uint32_t n, int64_t &min, int64_t &max) {
+  if(!n) return (void)(min = max = 0);
+  min = max = bp_mem_load(v.data, v.bytes, v.sign);
+  #ifdef BP_MEM_SIMD
+    if(v.bytes <= 2) {
+      uint32_t t = n;
+      bp_vec_minmax(v, t, min, max);
+      v.data += (n - t) * v.bytes;
+      n = t;
+    }
+  #endif
+  for(; n; n--, v.data += v.bytes) {
+    int64_t e = bp_mem_load(v.data, v.bytes, v.sign);
+    if(e < min) min = e;
+    if(e > max) max = e;
+  }
+};
+
+/* SCALE n elements: e = (e * mul) >> shift saturated to the element ----- */
+void bp_mem_scale(bp_mem_view_t v, uint32_t n, int64_t mul, uint8_t shift) {
+  if(shift > 63) shift = 63;
+  #ifdef BP_MEM_SIMD
+    if((v.bytes == 2) && v.sign && (mul >= INT16_MIN) && (mul <= INT16_MAX)) {
+      uint32_t t = n;
+      bp_vec_scale(v, t, (int16_t)mul, shift);
+      v.data += (n - t) * v.bytes;
+      n = t;
+    }
+  #endif
+  for(; n; n--, v.data += v.bytes) {
+    int64_t e = bp_mem_load(v.data, v.bytes, v.sign);
+    e = (int64_t)((uint64_t)e * (uint64_t)mul) >> shift;
+    bp_mem_store(v.data, v.bytes, bp_mem_clamp(e, v.bytes, v.sign));
+  }
+};
+
+/* DOT PRODUCT of n elements of two views --------------------------------- */
+int64_t bp_mem_dot(bp_mem_view_t a, bp_mem_view_t b, uint32_t n) {
+  uint64_t r = 0;
+  #ifdef BP_MEM_SIMD
+    if((a.bytes <= 2) && (a.bytes == b.bytes) && (a.sign == b.sign)) {
+      uint32_t t = n;
+      r = bp_vec_dot(a, b, t);
+      a.data += (n - t) * a.bytes;
+      b.data += (n - t) * b.bytes;
+      n = t;
+    }
+  #endif
+  for(; n; n--, a.data += a.bytes, b.data += b.bytes)
+    r += (uint64_t)bp_mem_load(a.data, a.bytes, a.sign) *
+      (uint64_t)bp_mem_load(b.data, b.bytes, b.sign);
+  return (int64_t)r;
+};
+
+/* BYTE STRINGS -----------------------------------------------------------
+   Used by the string builtins, on x86-64 BP_VEC_SIZE bytes are compared
+   at once. */
+
+#ifdef BP_MEM_SIMD
+  #define bp_vec_match(A, B) \
+    (uint32_t)BP_VEC(movemask_epi8)(BP_VEC(cmpeq_epi8)(A, B))
+  #define BP_VEC_MATCH_ALL (uint32_t)((1ULL << BP_VEC_SIZE) - 1)
+#endif
+
+/* Index of the first different byte of a and b or l if equal ------------ */
+uint32_t bp_mem_mismatch(const uint8_t *a, const uint8_t *b, uint32_t l) {
+  uint32_t i = 0;
+  #ifdef BP_MEM_SIMD
+    for(; (i + BP_VEC_SIZE) <= l; i += BP_VEC_SIZE) {
+      uint32_t m = bp_vec_match(bp_vec_load(a + i), bp_vec_load(b + i));
+      if(m == BP_VEC_MATCH_ALL) continue;
+      for(; m & 1; m >>= 1) i++;
+      return i;
+    }
+  #endif
+  for(; (i < l) && (a[i] == b[i]); i++);
+  return i;
+};
+
+/* Index of the first occurrence of n in h or -1, candidates are filtered
+   comparing the first and last byte of n at BP_VEC_SIZE positions. */
+int32_t bp_mem_find(
+  const uint8_t *h,
+  uint32_t hl,
+  const uint8_t *n,
+  uint32_t nl
+) {
+  if(!nl) return 0;
+  if(nl > hl) return -1;
+  uint32_t i = 0, last = hl - nl;
+  #ifdef BP_MEM_SIMD
+    bp_vec_t f = BP_VEC(set1_epi8)((char)n[0]);
+    bp_vec_t e = BP_VEC(set1_epi8)((char)n[nl - 1]);
+    for(; (i + BP_VEC_SIZE) <= (last + 1); i += BP_VEC_SIZE) {
+      uint32_t m = bp_vec_match(bp_vec_load(h + i), f) &
+        bp_vec_match(bp_vec_load(h + i + nl - 1), e);
+      for(uint32_t j = i; m; m >>= 1, j++)
+        if((m & 1) && !memcmp(h + j, n, nl)) return j;
+    }
+  #endif
+  for(; i <= last; i++)
+    if((h[i] == n[0]) && !memcmp(h + i, n, nl)) return i;
+  return -1;
+};
@@ -0,0 +1,146 @@
+
+/* ______     ______           ______   _
+  |      | | |      | |              | | \    |
+  |_____/  | |______| |        ______| |  \   |
+  |     \  | |        |       |      | |   \  |
+  |______| | |        |______ |______| |    \_| CR.1
+  Byte coded Interpreted Programming Language
+  Giovanni Blu Mitolo 2017-2020 - gioscarab@gmail.com
+      _____              _________________________
+     |   | |            |_________________________|
+     |   | |_______________||__________   \___||_________ |
+   __|___|_|               ||          |__|   ||     |   ||
+  /________|_______________||_________________||__   |   |D
+    (O)                 |_________________________|__|___/|
+                                           \ /            |
+                                           (O)
+  BIPLAN Copyright (c) 2017-2020, Giovanni Blu Mitolo All rights reserved.
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License. */
+
+#pragma once
+#include "BIPLAN_Defines.h"
+#include <math.h>
+
+/* NUMBER CONVERSION ------------------------------------------------------
+   Conversions between decimal or hexadecimal text and BP_VAR_TYPE used to
+   read numeric literals and atol arguments and to print numbers. They do
+   not depend on the host C library, the locale or errno and never handle
+   more than BP_NUM_MAX_LENGTH digits. Integer square root and
+   pseudo-random numbers follow, they use neither floating point nor the
+   host generator. */
+
+#if defined(__AVR__)
+  #include <avr/pgmspace.h>
+  #define BP_NUM_TABLE PROGMEM
+  #define BP_NUM_TABLE_READ(P) pgm_read_byte(P)
+#else
+  #define BP_NUM_TABLE
+  #define BP_NUM_TABLE_READ(P) (*(P))
+#endif
+
+/* Pairs of digits from 00 to 99, two digits are produced per division -- */
+const char bp_num_pairs[201] BP_NUM_TABLE =
+  "000102030405060708091011121314151617181920212223242526272829"
+  "303132333435363738394041424344454647484950515253545556575859"
+  "606162636465666768697071727374757677787980818283848586878889"
+  "90919293949596979899";
+
+/* TEXT TO NUMBER ---------------------------------------------------------
+   Skips leading white space, reads an optional sign and up to
+   BP_NUM_MAX_LENGTH decimal digits, overflow wraps around. */
+BP_VAR_TYPE bp_atol(const char *s) {
+  BP_UVAR_TYPE v = 0;
+  bool minus = false;
+  while((*s == ' ') || ((*s >= '\t') && (*s <= '\r'))) s++;
+  if((*s == '-') || (*s == '+')) minus = (*(s++) == '-');
+  for(uint8_t i = 0; (i < BP_NUM_MAX_LENGTH) && (*s >= '0') && (*s <= '9'); i++)
+    v = (v * 10) + (uint8_t)(*(s++) - '0');
+  return (BP_VAR_TYPE)(minus ? 0 - v : v);
+};
+
+/* NUMBER TO TEXT (d must fit BP_NUM_MAX_LENGTH + 2 characters) -----------
+   Writes v in base 10 or 16 followed by a null terminator and returns the
+   amount of characters written, base 16 prints the bits of negative
+   numbers. */
+uint8_t bp_ltoa(char *d, BP_VAR_TYPE v, uint8_t base) {
+  char n[BP_NUM_MAX_LENGTH];
+  uint8_t i = BP_NUM_MAX_LENGTH, l = 0;
+  BP_UVAR_TYPE u = v;
+  if(base == 16) {
+    do n[--i] = "0123456789abcdef"[u & 15]; while(u >>= 4);
+  } else {
+    if(v < 0) {
+      d[l++] = '-';
+      u = 0 - u;
+    }
+    while(u >= 100) {
+      uint8_t r = (u % 100) * 2;
+      u /= 100;
+      n[--i] = BP_NUM_TABLE_READ(bp_num_pairs + r + 1);
+      n[--i] = BP_NUM_TABLE_READ(bp_num_pairs + r);
+    }
+    if(u >= 10) {
+      n[--i] = BP_NUM_TABLE_READ(bp_num_pairs + (u * 2) + 1);
+      n[--i] = BP_NUM_TABLE_READ(bp_num_pairs + (u * 2));
+    } else n[--i] = '0' + u;
+  }
+  while(i < BP_NUM_MAX_LENGTH) d[l++] = n[i++];
+  d[l] = 0;
+  return l;
+};
+
+/* INTEGER SQUARE ROOT ----------------------------------------------------
+   Computed bit by bit, exact for any BP_VAR_TYPE width, 0 if v <= 0. */
+BP_VAR_TYPE bp_isqrt(BP_VAR_TYPE v) {
+  if(v <= 0) return 0;
+  BP_UVAR_TYPE n = v, r = 0;
+  BP_UVAR_TYPE b = (BP_UVAR_TYPE)1 << ((sizeof(v) * 8) - 2);
+  while(b > n) b >>= 2;
+  for(; b; b >>= 2)
+    if(n >= (r + b)) {
+      n -= r + b;
+      r = (r >> 1) + b;
+    } else r >>= 1;
+  return (BP_VAR_TYPE)r;
+};
+
+/* Hosts with a floating point unit round the double square root, which is
+   inexact above 2^52, and correct it to the same result of bp_isqrt. */
+BP_VAR_TYPE bp_fsqrt(BP_VAR_TYPE v) {
+  if(v <= 0) return 0;
+  BP_UVAR_TYPE n = v, r = (BP_UVAR_TYPE)sqrt((double)v);
+  while((r * r) > n) r--;
+  while(((r + 1) * (r + 1)) <= n) r++;
+  return (BP_VAR_TYPE)r;
+};
+
+/* PSEUDO-RANDOM NUMBERS --------------------------------------------------
+   xorshift32, the state is kept by the caller (each interpreter has its
+   own) and the same seed produces the same sequence on any architecture.
+   Returns a number from min to max - 1, min if max <= min. */
+uint32_t bp_random_next(uint32_t &state) {
+  uint32_t x = state ? state : 1; // 0 would always return 0
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return state = x;
+};
+
+BP_VAR_TYPE bp_random(uint32_t &state, BP_VAR_TYPE min, BP_VAR_TYPE max) {
+  if(max <= min) return min;
+  BP_UVAR_TYPE range = (BP_UVAR_TYPE)max - min;
+  BP_UVAR_TYPE v = bp_random_next(state);
+  if((sizeof(v) > 4) && (range > 0xFFFFFFFF)) // << 16 << 16 for 32 bits
+    v = (v << 16 << 16) | bp_random_next(state);
+  return (BP_VAR_TYPE)(min + (v % range));
+};
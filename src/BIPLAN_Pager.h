@@ -0,0 +1,141 @@
+
+/* ______     ______           ______   _
+  |      | | |      | |              | | \    |
+  |_____/  | |______| |        ______| |  \   |
+  |     \  | |        |       |      | |   \  |
+  |______| | |        |______ |______| |    \_| CR.1
+  Byte coded Interpreted Programming Language
+  Giovanni Blu Mitolo 2017-2020 - gioscarab@gmail.com
+      _____              _________________________
+     |   | |            |_________________________|
+     |   | |_______________||__________   \___||_________ |
+   __|___|_|               ||          |__|   ||     |   ||
+  /________|_______________||_________________||__   |   |D
+    (O)                 |_________________________|__|___/|
+                                           \ /            |
+                                           (O)
+  BIPLAN Copyright (c) 2017-2020, Giovanni Blu Mitolo All rights reserved.
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License. */
+
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+/* PAGED PROGRAM MEMORY ---------------------------------------------------
+   Programs larger than RAM are read on demand in fixed-size pages from a
+   storage callback into a small LRU page cache. Each interpreter holds its
+   own pager (BIPLAN_Interpreter::pager), bp_pager_init prepares it and
+   returns the position of the program in storage, it can be passed to
+   initialize (BIP text) or load (BIP container). With BP_PAGED program
+   positions are storage offsets (see bp_code_t) and each byte is read by
+   bp_pager_read from the pager of the interpreter running in the thread
+   (see decoder_own). Reading past the end of storage returns 0, so BIP
+   text needs no terminator.
+
+   The storage callback receives the program address of the page and
+   returns the amount of bytes it wrote in data (at most length):
+   uint16_t read_page(uint32_t address, uint8_t *data, uint16_t length); */
+
+#ifndef BP_PAGE_SIZE
+  #define BP_PAGE_SIZE 64
+#endif
+
+#ifndef BP_PAGES
+  #define BP_PAGES 4
+#endif
+
+typedef uint16_t (*bp_page_source_t)(uint32_t, uint8_t *, uint16_t);
+
+struct bp_page_t {
+  uint32_t number;
+  uint32_t used;
+  uint8_t data[BP_PAGE_SIZE];
+};
+
+struct bp_pager_t {
+  bp_page_source_t source = NULL;
+  bp_page_t pages[BP_PAGES];
+  uint8_t  count = BP_PAGES; // Pages used, at most BP_PAGES
+  uint8_t  loaded = 0;
+  uint8_t  last = 0;
+  uint32_t clock = 0;
+  uint32_t hits = 0;
+  uint32_t misses = 0; // Pages loaded from storage
+};
+
+BPM_DECODER_STORAGE bp_pager_t *bp_pager = NULL; // Set by decoder_own
+
+/* INITIALIZE, pages can be reduced below BP_PAGES ------------------------ */
+uint32_t bp_pager_init(
+  bp_pager_t &pager,
+  bp_page_source_t source,
+  uint8_t pages = BP_PAGES
+) {
+  pager.source = source;
+  pager.count = (pages && (pages < BP_PAGES)) ? pages : BP_PAGES;
+  pager.loaded = pager.last = 0;
+  pager.clock = pager.hits = pager.misses = 0;
+  return 0;
+};
+
+/* LOAD A PAGE IN A FREE SLOT OR IN THE LEAST RECENTLY USED ONE ----------- */
+uint8_t bp_pager_load(bp_pager_t &pager, uint32_t number) {
+  uint8_t slot = 0;
+  uint16_t length;
+  if(pager.loaded < pager.count) slot = pager.loaded++;
+  else for(uint8_t i = 1; i < pager.count; i++)
+    if(pager.pages[i].used < pager.pages[slot].used) slot = i;
+  length = pager.source(
+    number * BP_PAGE_SIZE, pager.pages[slot].data, BP_PAGE_SIZE
+  );
+  if(length < BP_PAGE_SIZE)
+    memset(pager.pages[slot].data + length, 0, BP_PAGE_SIZE - length);
+  pager.pages[slot].number = number;
+  pager.misses++;
+  return slot;
+};
+
+/* RENUMBER THE PAGES IN ORDER OF USE WHEN THE CLOCK WRAPS --------------- */
+void bp_pager_rebase(bp_pager_t &pager) {
+  uint32_t order[BP_PAGES];
+  for(uint8_t i = 0; i < pager.loaded; i++) {
+    order[i] = 1;
+    for(uint8_t j = 0; j < pager.loaded; j++)
+      if(pager.pages[j].used < pager.pages[i].used) order[i]++;
+  }
+  for(uint8_t i = 0; i < pager.loaded; i++) pager.pages[i].used = order[i];
+  pager.clock = pager.loaded + 1;
+};
+
+/* READ A PROGRAM BYTE ---------------------------------------------------- */
+uint8_t bp_pager_read(bp_pager_t &pager, uint32_t address) {
+  uint32_t number = address / BP_PAGE_SIZE;
+  uint8_t slot = pager.last;
+  // Code is mostly read sequentially, the last page used is checked first
+  if(!pager.loaded || (pager.pages[slot].number != number)) {
+    for(slot = 0; slot < pager.loaded; slot++)
+      if(pager.pages[slot].number == number) break;
+    if(slot == pager.loaded) slot = bp_pager_load(pager, number);
+    else pager.hits++;
+  } else pager.hits++;
+  if(!++pager.clock) bp_pager_rebase(pager); // Stamps would restart from 0
+  pager.pages[slot].used = pager.clock;
+  pager.last = slot;
+  return pager.pages[slot].data[address % BP_PAGE_SIZE];
+};
+
+/* PAGE HIT RATE (percentage of reads served by the cache) ---------------- */
+uint8_t bp_pager_hit_rate(const bp_pager_t &pager) {
+  uint32_t reads = pager.hits + pager.misses;
+  return reads ? (uint8_t)(((uint64_t)pager.hits * 100) / reads) : 100;
+};
@@ -21,10 +21,11 @@
 #if defined(ARDUINO)
   #include "Arduino.h"
 
-  /* String conversion ---------------------------------------------------- */
+  /* Program memory ------------------------------------------------------- */
 
-  #ifndef BPM_ATOL
-    #define BPM_ATOL atol
+  // Define BP_PROGMEM to execute precompiled programs stored with PROGMEM
+  #if defined(BP_PROGMEM) && !defined(BPM_PROGRAM_READ)
+    #define BPM_PROGRAM_READ(P) pgm_read_byte(P)
   #endif
 
   /* Arduino IO system calls ---------------------------------------------- */
@@ -49,12 +50,130 @@
     #define BPM_IO_MODE pinMode
   #endif
 
-  /* Random --------------------------------------------------------------- */
+  /* Port-wide IO ---------------------------------------------------------
+     Bit i of the mask is the state of pin + i. On AVR pins sharing a port
+     are written or read at once with a single port register access
+     (PWM is not disabled as digitalWrite does) and shiftOut toggles the
+     port registers directly. */
+
+  void bp_arduino_write_mask(long pin, uint8_t n, uint32_t mask) {
+    #if defined(__AVR__)
+      for(uint8_t i = 0; i < n; ) {
+        uint8_t port = digitalPinToPort(pin + i), set = 0, clear = 0;
+        for(; (i < n) && (digitalPinToPort(pin + i) == port); i++, mask >>= 1)
+          if(mask & 1) set |= digitalPinToBitMask(pin + i);
+          else clear |= digitalPinToBitMask(pin + i);
+        if(port == NOT_A_PIN) continue;
+        volatile uint8_t *out = portOutputRegister(port);
+        uint8_t sreg = SREG;
+        cli();
+        *out = (*out & ~clear) | set;
+        SREG = sreg;
+      }
+    #else
+      for(uint8_t i = 0; i < n; i++, mask >>= 1)
+        digitalWrite(pin + i, mask & 1);
+    #endif
+  };
+
+  uint32_t bp_arduino_read_mask(long pin, uint8_t n) {
+    uint32_t mask = 0;
+    #if defined(__AVR__)
+      for(uint8_t i = 0; i < n; ) {
+        uint8_t port = digitalPinToPort(pin + i);
+        uint8_t in = (port == NOT_A_PIN) ? 0 : *portInputRegister(port);
+        for(; (i < n) && (digitalPinToPort(pin + i) == port); i++)
+          if(in & digitalPinToBitMask(pin + i)) mask |= (uint32_t)1 << i;
+      }
+    #else
+      for(uint8_t i = 0; i < n; i++)
+        if(digitalRead(pin + i)) mask |= (uint32_t)1 << i;
+    #endif
+    return mask;
+  };
+
+  void bp_arduino_shift_out(long data, long clock, uint8_t value) {
+    #if defined(__AVR__)
+      uint8_t d = digitalPinToPort(data), c = digitalPinToPort(clock);
+      if((d == NOT_A_PIN) || (c == NOT_A_PIN)) return;
+      volatile uint8_t *dr = portOutputRegister(d), *cr = portOutputRegister(c);
+      uint8_t db = digitalPinToBitMask(data), cb = digitalPinToBitMask(clock);
+      uint8_t sreg = SREG;
+      cli();
+      for(uint8_t i = 0; i < 8; i++, value <<= 1) {
+        if(value & 0x80) *dr |= db;
+        else *dr &= ~db;
+        *cr |= cb;
+        *cr &= ~cb;
+      }
+      SREG = sreg;
+    #else
+      shiftOut(data, clock, MSBFIRST, value);
+    #endif
+  };
+
+  #ifndef BPM_IO_WRITE_MASK
+    #define BPM_IO_WRITE_MASK bp_arduino_write_mask
+  #endif
+
+  #ifndef BPM_IO_READ_MASK
+    #define BPM_IO_READ_MASK bp_arduino_read_mask
+  #endif
+
+  #ifndef BPM_IO_SHIFT_OUT
+    #define BPM_IO_SHIFT_OUT bp_arduino_shift_out
+  #endif
+
+  /* Burst sampling -------------------------------------------------------
+     On AVR, after the channel is selected by analogRead, conversions are
+     started directly with a faster ADC clock (prescaler 16 by default, 1MHz
+     at 16MHz, about 70k samples per second with a reduced accuracy). */
+
+  #ifndef BP_ADC_PRESCALER // ADPS2:0 bits, 7 is the Arduino default (128)
+    #define BP_ADC_PRESCALER 4
+  #endif
 
-  #ifndef BPM_RANDOM
-    #define BPM_RANDOM random
+  void bp_arduino_aread_burst(
+    uint8_t pin,
+    uint8_t *data,
+    uint8_t bytes,
+    uint32_t n,
+    uint32_t interval
+  ) {
+    uint32_t t = micros();
+    uint16_t v;
+    #if defined(__AVR__) && defined(ADCSRA) && defined(ADSC)
+      analogRead(pin); // Select the channel
+      uint8_t adcsra = ADCSRA;
+      ADCSRA = (adcsra & ~7) | BP_ADC_PRESCALER;
+    #endif
+    for(uint32_t i = 0; i < n; i++) {
+      if(i) {
+        while((uint32_t)(micros() - t) < interval);
+        t += interval;
+      }
+      #if defined(__AVR__) && defined(ADCSRA) && defined(ADSC)
+        ADCSRA |= (1 << ADSC);
+        while(ADCSRA & (1 << ADSC));
+        v = ADC;
+      #else
+        v = analogRead(pin);
+      #endif
+      for(uint8_t b = 0; b < bytes; b++, v >>= 8) *(data++) = v;
+    }
+    #if defined(__AVR__) && defined(ADCSRA) && defined(ADSC)
+      ADCSRA = adcsra;
+    #endif
+  };
+
+  #ifndef BPM_AREAD_BURST
+    #define BPM_AREAD_BURST bp_arduino_aread_burst
   #endif
 
+  /* Random --------------------------------------------------------------- */
+
+  // Define BPM_RANDOM as random to use the Arduino generator
+
   #ifndef BPM_RANDOM_SEED
     #define BPM_RANDOM_SEED randomSeed
   #endif
@@ -63,16 +182,15 @@
 
   #ifndef BPM_PRINT_TYPE
     #define BPM_PRINT_TYPE Stream *
+    #ifndef BPM_PRINT_FLUSH // Streams of other types are not flushed
+      #define BPM_PRINT_FLUSH(S) S->flush()
+    #endif
   #endif
 
   #ifndef BPM_PRINT_WRITE
     #define BPM_PRINT_WRITE(S, C) S->print(C)
   #endif
 
-  #ifndef BPM_PRINT_FLUSH
-    #define BPM_PRINT_FLUSH(S) S->flush()
-  #endif
-
   /* Serial --------------------------------------------------------------- */
 
   #ifndef BPM_SERIAL_TYPE
@@ -91,6 +209,10 @@
     #define BPM_SERIAL_WRITE(S, D) S->write(D)
   #endif
 
+  #ifndef BPM_SERIAL_WRITE_BUF
+    #define BPM_SERIAL_WRITE_BUF(S, P, L) S->write((const uint8_t *)(P), L)
+  #endif
+
   /* User input ----------------------------------------------------------- */
 
   #ifndef BPM_INPUT_TYPE
@@ -123,4 +245,45 @@
     #define BPM_MILLIS millis
   #endif
 
+  /* Events ---------------------------------------------------------------
+     Pin changes are detected by interrupts, each of the 4 trampolines
+     below signals the event armed on its pin. Pins without an interrupt
+     and serial data (no interrupt is exposed by Stream) are polled before
+     each statement. */
+
+  bp_event_t *bp_arduino_events[4];
+  long bp_arduino_event_pins[4];
+
+  template<uint8_t S> void bp_arduino_event_isr() {
+    bp_event_signal(bp_arduino_events[S]);
+  };
+
+  void (*const bp_arduino_event_isrs[4])() = {
+    bp_arduino_event_isr<0>, bp_arduino_event_isr<1>,
+    bp_arduino_event_isr<2>, bp_arduino_event_isr<3>
+  };
+
+  bool bp_arduino_event_pin(bp_event_t *e, long pin) {
+    int n = digitalPinToInterrupt(pin);
+    uint8_t slot = 4;
+    #ifdef NOT_AN_INTERRUPT
+      if(n == NOT_AN_INTERRUPT) return false;
+    #endif
+    for(uint8_t i = 4; i; i--)
+      if(bp_arduino_events[i - 1] == e) { // Moved from another pin
+        detachInterrupt(digitalPinToInterrupt(bp_arduino_event_pins[i - 1]));
+        slot = i - 1;
+        break;
+      } else if(!bp_arduino_events[i - 1]) slot = i - 1;
+    if(slot == 4) return false;
+    bp_arduino_events[slot] = e;
+    bp_arduino_event_pins[slot] = pin;
+    attachInterrupt(n, bp_arduino_event_isrs[slot], CHANGE);
+    return true;
+  };
+
+  #ifndef BPM_EVENT_PIN
+    #define BPM_EVENT_PIN bp_arduino_event_pin
+  #endif
+
 #endif
@@ -0,0 +1,64 @@
+/* BIPLAN epoll event sources
+   ___________________________________________________________________________
+
+    Copyright 2020 Giovanni Blu Mitolo gioscarab@gmail.com
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License. */
+
+#pragma once
+#include <errno.h>
+#include <sys/epoll.h>
+#include <thread>
+
+/* EPOLL EVENT SOURCES ----------------------------------------------------
+   Used by the interfaces of hosts running Linux (LINUX, RPI). File
+   descriptors (serial ports, pipes, sockets) armed with
+   bp_epoll_watch are watched by a thread started the first time, which
+   signals the event when new data arrives (edge triggered, data left
+   unread signals it again, see events_dispatch). The program is not
+   interrupted, the handler is called before its next statement. */
+
+#ifndef BP_EPOLL_EVENTS
+  #define BP_EPOLL_EVENTS 8
+#endif
+
+void bp_epoll_run(int fd) {
+  struct epoll_event ready[BP_EPOLL_EVENTS];
+  for(;;) {
+    int n = epoll_wait(fd, ready, BP_EPOLL_EVENTS, -1);
+    for(int i = 0; i < n; i++)
+      bp_event_signal((bp_event_t *)ready[i].data.ptr);
+  }
+};
+
+int bp_epoll_open() {
+  int fd = epoll_create1(EPOLL_CLOEXEC);
+  if(fd >= 0) std::thread(bp_epoll_run, fd).detach();
+  return fd;
+};
+
+/* Shared by all interpreters, created once also if they start together */
+int bp_epoll_fd() {
+  static int fd = bp_epoll_open();
+  return fd;
+};
+
+bool bp_epoll_watch(bp_event_t *e, int fd) {
+  struct epoll_event w = {};
+  int epoll_fd = bp_epoll_fd();
+  if(epoll_fd < 0) return false;
+  w.events = EPOLLIN | EPOLLET;
+  w.data.ptr = e;
+  if(!epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &w)) return true;
+  return (errno == EEXIST) && !epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &w);
+};
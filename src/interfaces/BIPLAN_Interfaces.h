@@ -4,4 +4,4 @@
 #include "ARDUINO/BIPLAN_ARDUINO_Interface.h"
 #include "RPI/BIPLAN_RPI_Interface.h"
 #include "WINX86/BIPLAN_WINX86_Interface.h"
-//#include "LINUX/BIPLAN_LINUX_Interface.h"
+#include "LINUX/BIPLAN_LINUX_Interface.h"
@@ -0,0 +1,86 @@
+/* BIPLAN simulated pin bank
+   ___________________________________________________________________________
+
+    Copyright 2020 Giovanni Blu Mitolo gioscarab@gmail.com
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License. */
+
+#pragma once
+#include <stdint.h>
+
+/* SIMULATED PIN BANK -----------------------------------------------------
+   Used by the interfaces of hosts without physical pins (LINUX, WINX86).
+   Pins keep their mode and state, rising edges are counted and the bytes
+   shifted out are logged, so programs driving pins can be tested on the
+   host. Pins outside the bank read 0 and ignore writes. A pin armed with
+   bp_sim_event signals its event when its state changes. */
+
+#ifndef BP_SIM_PINS
+  #define BP_SIM_PINS 64
+#endif
+
+#ifndef BP_SIM_SHIFT_LOG
+  #define BP_SIM_SHIFT_LOG 64
+#endif
+
+uint8_t  bp_sim_pin_mode[BP_SIM_PINS];
+uint8_t  bp_sim_pin_state[BP_SIM_PINS];
+uint32_t bp_sim_pin_edges[BP_SIM_PINS];
+uint8_t  bp_sim_shift_log[BP_SIM_SHIFT_LOG];
+uint32_t bp_sim_shifted = 0; // Bytes shifted out, the last are logged
+bp_event_t *bp_sim_pin_event[BP_SIM_PINS];
+
+void bp_sim_mode(long pin, long mode) {
+  if((pin >= 0) && (pin < BP_SIM_PINS)) bp_sim_pin_mode[pin] = mode;
+};
+
+void bp_sim_write(long pin, long value) {
+  if((pin < 0) || (pin >= BP_SIM_PINS)) return;
+  uint8_t state = (value != 0);
+  if(state && !bp_sim_pin_state[pin]) bp_sim_pin_edges[pin]++;
+  if((state != bp_sim_pin_state[pin]) && bp_sim_pin_event[pin])
+    bp_event_signal(bp_sim_pin_event[pin]);
+  bp_sim_pin_state[pin] = state;
+};
+
+bool bp_sim_event(bp_event_t *e, long pin) {
+  if((pin < 0) || (pin >= BP_SIM_PINS)) return false;
+  for(uint8_t i = 0; i < BP_SIM_PINS; i++) // Moved from another pin
+    if(bp_sim_pin_event[i] == e) bp_sim_pin_event[i] = NULL;
+  bp_sim_pin_event[pin] = e;
+  return true;
+};
+
+int bp_sim_read(long pin) {
+  return ((pin >= 0) && (pin < BP_SIM_PINS)) ? bp_sim_pin_state[pin] : 0;
+};
+
+void bp_sim_write_mask(long pin, uint8_t n, uint32_t mask) {
+  for(uint8_t i = 0; i < n; i++, mask >>= 1) bp_sim_write(pin + i, mask & 1);
+};
+
+uint32_t bp_sim_read_mask(long pin, uint8_t n) {
+  uint32_t mask = 0;
+  for(uint8_t i = n; i; i--) mask = (mask << 1) | bp_sim_read(pin + i - 1);
+  return mask;
+};
+
+/* Shift out a byte most significant bit first */
+void bp_sim_shift_out(long data, long clock, uint8_t value) {
+  bp_sim_shift_log[bp_sim_shifted++ % BP_SIM_SHIFT_LOG] = value;
+  for(uint8_t i = 0; i < 8; i++, value <<= 1) {
+    bp_sim_write(data, value & 0x80);
+    bp_sim_write(clock, 1);
+    bp_sim_write(clock, 0);
+  }
+};
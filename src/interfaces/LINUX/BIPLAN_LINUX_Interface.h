@@ -0,0 +1,419 @@
+/* BIPLAN Linux Interface
+   ___________________________________________________________________________
+
+    Copyright 2020 Giovanni Blu Mitolo gioscarab@gmail.com
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License. */
+
+#pragma once
+
+#if defined(__linux__) && !defined(RPI) && !defined(ARDUINO)
+  #include <inttypes.h>
+  #include <stdio.h>
+  #include <stdlib.h>
+  #include <string.h>
+  #include <math.h>
+  #include <errno.h>
+  #include <fcntl.h>
+  #include <poll.h>
+  #include <unistd.h>
+  #include <termios.h>
+  #include <time.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <thread>
+  #include "../BIPLAN_Simulated_IO.h"
+  #include "../BIPLAN_Epoll_Events.h"
+
+  #define OUTPUT 1
+  #define INPUT 0
+  #define HIGH 1
+  #define LOW 0
+
+  /* Monotonic clock and delays -------------------------------------------
+     Time is read from CLOCK_MONOTONIC (not affected by changes of the
+     system time), delays sleep until an absolute deadline so signals
+     interrupting the sleep do not extend or shorten them. */
+
+  uint64_t bp_linux_ns() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + t.tv_nsec;
+  };
+
+  void bp_linux_sleep_until(uint64_t ns) {
+    struct timespec t;
+    t.tv_sec = ns / 1000000000ULL;
+    t.tv_nsec = ns % 1000000000ULL;
+    while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &t, NULL) == EINTR);
+  };
+
+  uint64_t bp_linux_start = bp_linux_ns();
+
+  uint32_t micros() {
+    return (uint32_t)((bp_linux_ns() - bp_linux_start) / 1000);
+  };
+
+  uint32_t millis() {
+    return (uint32_t)((bp_linux_ns() - bp_linux_start) / 1000000);
+  };
+
+  void delayMicroseconds(uint32_t delay_value) {
+    bp_linux_sleep_until(bp_linux_ns() + delay_value * 1000ULL);
+  };
+
+  void delay(uint32_t delay_value_ms) {
+    bp_linux_sleep_until(bp_linux_ns() + delay_value_ms * 1000000ULL);
+  };
+
+  /* Batched reads --------------------------------------------------------
+     Bytes are read in blocks of up to BP_LINUX_READ_BUFFER and returned
+     one at a time, reading a line costs a couple of system calls instead
+     of two for each byte. Each thread buffers up to 4 file descriptors
+     (serial port and user input), bytes buffered are not seen by other
+     readers of the same file descriptor. */
+
+  #ifndef BP_LINUX_READ_BUFFER
+    #define BP_LINUX_READ_BUFFER 256
+  #endif
+
+  struct bp_linux_buffer_t {
+    int fd = -1;
+    uint16_t head = 0;
+    uint16_t tail = 0;
+    uint8_t data[BP_LINUX_READ_BUFFER];
+  };
+
+  thread_local bp_linux_buffer_t bp_linux_buffers[4];
+
+  bp_linux_buffer_t *bp_linux_buffer(int fd) {
+    bp_linux_buffer_t *b = NULL;
+    for(uint8_t i = 0; i < 4; i++)
+      if(bp_linux_buffers[i].fd == fd) return &bp_linux_buffers[i];
+      else if(!b && (bp_linux_buffers[i].head == bp_linux_buffers[i].tail))
+        b = &bp_linux_buffers[i]; // Empty, can be used by another fd
+    if(b) b->fd = fd;
+    return b;
+  };
+
+  bool bp_linux_ready(int fd) {
+    struct pollfd p = {fd, POLLIN, 0};
+    return (poll(&p, 1, 0) > 0) && (p.revents & POLLIN);
+  };
+
+  /* Read a byte from a file descriptor, -1 if nothing is available ------- */
+
+  int bp_linux_read(int fd) {
+    bp_linux_buffer_t *b = bp_linux_buffer(fd);
+    uint8_t c;
+    if(!b) return (bp_linux_ready(fd) && (read(fd, &c, 1) == 1)) ? c : -1;
+    if(b->head == b->tail) {
+      ssize_t n = bp_linux_ready(fd) ? read(fd, b->data, sizeof(b->data)) : 0;
+      if(n <= 0) return -1;
+      b->head = 0;
+      b->tail = n;
+    }
+    return b->data[b->head++];
+  };
+
+  /* Check if a byte can be read, without reading it ---------------------- */
+
+  bool bp_linux_available(int fd) {
+    for(uint8_t i = 0; i < 4; i++)
+      if(bp_linux_buffers[i].fd == fd)
+        if(bp_linux_buffers[i].head != bp_linux_buffers[i].tail) return true;
+    return bp_linux_ready(fd);
+  };
+
+  /* Open a serial port (termios), raw and non-blocking, -1 if it fails -- */
+
+  int bp_linux_serial_open(const char *path, uint32_t baud) {
+    struct termios t;
+    speed_t s;
+    switch(baud) {
+      case 1200: s = B1200; break;
+      case 2400: s = B2400; break;
+      case 4800: s = B4800; break;
+      case 9600: s = B9600; break;
+      case 19200: s = B19200; break;
+      case 38400: s = B38400; break;
+      case 57600: s = B57600; break;
+      case 115200: s = B115200; break;
+      case 230400: s = B230400; break;
+      case 460800: s = B460800; break;
+      case 921600: s = B921600; break;
+      default: return -1;
+    }
+    int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if(fd < 0) return -1;
+    if(tcgetattr(fd, &t) < 0) {
+      close(fd);
+      return -1;
+    }
+    cfmakeraw(&t);
+    cfsetispeed(&t, s);
+    cfsetospeed(&t, s);
+    t.c_cflag |= CLOCAL | CREAD;
+    t.c_cc[VMIN] = 0;
+    t.c_cc[VTIME] = 0;
+    if(tcsetattr(fd, TCSANOW, &t) < 0) {
+      close(fd);
+      return -1;
+    }
+    tcflush(fd, TCIOFLUSH);
+    return fd;
+  };
+
+  /* Write all the bytes of a buffer, retrying partial writes ------------- */
+
+  void bp_linux_write(int fd, const void *data, uint32_t l) {
+    const uint8_t *p = (const uint8_t *)data;
+    while(l) {
+      ssize_t n = write(fd, p, l);
+      if(n > 0) {
+        p += n;
+        l -= n;
+      } else if((n < 0) && (errno == EAGAIN)) {
+        struct pollfd w = {fd, POLLOUT, 0};
+        poll(&w, 1, -1);
+      } else if((n == 0) || (errno != EINTR)) return;
+    }
+  };
+
+  /* Print ---------------------------------------------------------------- */
+
+  void bp_linux_print(FILE *f, const char *s) { fputs(s, f); };
+  void bp_linux_print(FILE *f, char c) { fputc(c, f); };
+  void bp_linux_print(FILE *f, int v) { fprintf(f, "%d", v); };
+  void bp_linux_print(FILE *f, long v) { fprintf(f, "%ld", v); };
+  void bp_linux_print(FILE *f, long long v) { fprintf(f, "%lld", v); };
+
+  /* Square root (floating point, see bp_fsqrt) --------------------------- */
+
+  #ifndef BPM_SQRT
+    #define BPM_SQRT bp_fsqrt
+  #endif
+
+  /* Random --------------------------------------------------------------- */
+
+  long bp_linux_random(long max) {
+    return (long)((1.0 * max) * rand() / (RAND_MAX + 1.0));
+  };
+
+  long bp_linux_random(long min, long max) {
+    return min + bp_linux_random(max - min);
+  };
+
+  /* Map a precompiled program read-only (see BIPLAN_Container.h) --------- */
+
+  const uint8_t *bp_linux_map(const char *path, uint32_t *size) {
+    struct stat s;
+    void *m;
+    int fd = open(path, O_RDONLY);
+    if(fd < 0) return NULL;
+    if((fstat(fd, &s) < 0) || !s.st_size || (s.st_size > UINT32_MAX)) {
+      close(fd);
+      return NULL;
+    } // Pages are shared by all the processes mapping the same file
+    m = mmap(NULL, s.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(m == MAP_FAILED) return NULL;
+    *size = s.st_size;
+    return (const uint8_t *)m;
+  };
+
+  void bp_linux_unmap(const uint8_t *image, uint32_t size) {
+    munmap((void *)image, size);
+  };
+
+  /* Read program pages from a file (see BIPLAN_Pager.h) ------------------ */
+
+  int bp_linux_page_fd = -1;
+
+  uint16_t bp_linux_page_read(uint32_t address, uint8_t *data, uint16_t l) {
+    ssize_t n = pread(bp_linux_page_fd, data, l, address);
+    return (n > 0) ? n : 0;
+  };
+
+  bool bp_linux_page_open(const char *path) {
+    if(bp_linux_page_fd >= 0) close(bp_linux_page_fd);
+    return (bp_linux_page_fd = open(path, O_RDONLY)) >= 0;
+  };
+
+  /* Simulated ADC --------------------------------------------------------
+     analogRead returns bp_linux_adc(pin, time in microseconds), by default
+     a 10 bits sine wave of (pin + 1) * 50Hz. Assign a different source to
+     bp_linux_adc to feed recorded or synthetic signals. */
+
+  uint16_t bp_linux_adc_sine(uint8_t pin, uint32_t us) {
+    return 512 + (int)lround(511 * sin(2 * M_PI * (pin + 1) * 50e-6 * us));
+  };
+
+  uint16_t (*bp_linux_adc)(uint8_t, uint32_t) = bp_linux_adc_sine;
+
+  /* Burst sampling, each sample is read at its scheduled time, intervals
+     longer than 100us sleep until it, shorter intervals busy-wait. */
+  void bp_linux_aread_burst(
+    uint8_t pin,
+    uint8_t *data,
+    uint8_t bytes,
+    uint32_t n,
+    uint32_t interval
+  ) {
+    uint64_t next = bp_linux_ns();
+    uint32_t t = micros();
+    for(uint32_t i = 0; i < n; i++, t += interval) {
+      if(i) {
+        next += interval * 1000ULL;
+        if(interval > 100) bp_linux_sleep_until(next);
+        else while(bp_linux_ns() < next);
+      }
+      uint32_t v = bp_linux_adc(pin, t);
+      for(uint8_t b = 0; b < bytes; b++, v >>= 8) *(data++) = v;
+    }
+  };
+
+  /* Generic constants ---------------------------------------------------- */
+
+  #ifndef A0
+    #define A0 0
+  #endif
+
+  #ifndef LED_BUILTIN
+    #define LED_BUILTIN -1
+  #endif
+
+  /* IO system calls (simulated pin bank and ADC) ------------------------ */
+
+  #if !defined(BPM_AREF)
+    #define BPM_AREF(R)
+  #endif
+
+  #if !defined(BPM_AREAD)
+    #define BPM_AREAD(P) bp_linux_adc(P, micros())
+  #endif
+
+  #if !defined(BPM_AREAD_BURST)
+    #define BPM_AREAD_BURST bp_linux_aread_burst
+  #endif
+
+  #if !defined(BPM_IO_WRITE)
+    #define BPM_IO_WRITE bp_sim_write
+  #endif
+
+  #if !defined(BPM_IO_READ)
+    #define BPM_IO_READ bp_sim_read
+  #endif
+
+  #if !defined(BPM_IO_MODE)
+    #define BPM_IO_MODE bp_sim_mode
+  #endif
+
+  #if !defined(BPM_IO_WRITE_MASK)
+    #define BPM_IO_WRITE_MASK bp_sim_write_mask
+  #endif
+
+  #if !defined(BPM_IO_READ_MASK)
+    #define BPM_IO_READ_MASK bp_sim_read_mask
+  #endif
+
+  #if !defined(BPM_IO_SHIFT_OUT)
+    #define BPM_IO_SHIFT_OUT bp_sim_shift_out
+  #endif
+
+  /* Random --------------------------------------------------------------- */
+
+  // Define BPM_RANDOM as bp_linux_random to use rand
+
+  #ifndef BPM_RANDOM_SEED
+    #define BPM_RANDOM_SEED srand
+  #endif
+
+  /* Print ---------------------------------------------------------------- */
+
+  #ifndef BPM_PRINT_TYPE
+    #define BPM_PRINT_TYPE FILE *
+    #ifndef BPM_PRINT_FLUSH // Streams of other types are not flushed
+      #define BPM_PRINT_FLUSH(S) fflush(S)
+    #endif
+  #endif
+
+  #ifndef BPM_PRINT_WRITE
+    #define BPM_PRINT_WRITE(S, C) bp_linux_print(S, C)
+  #endif
+
+  /* Serial (file descriptor of a tty or pipe) ---------------------------- */
+
+  #ifndef BPM_SERIAL_TYPE
+    #define BPM_SERIAL_TYPE int
+  #endif
+
+  #ifndef BPM_SERIAL_AVAILABLE
+    #define BPM_SERIAL_AVAILABLE(S) bp_linux_available(S)
+  #endif
+
+  #ifndef BPM_SERIAL_READ
+    #define BPM_SERIAL_READ(S) bp_linux_read(S)
+  #endif
+
+  #ifndef BPM_SERIAL_WRITE
+    #define BPM_SERIAL_WRITE(S, C) \
+      do { uint8_t bp_b = (C); bp_linux_write(S, &bp_b, 1); } while(0)
+  #endif
+
+  #ifndef BPM_SERIAL_WRITE_BUF
+    #define BPM_SERIAL_WRITE_BUF bp_linux_write
+  #endif
+
+  /* User input (file descriptor, 0 for stdin) ---------------------------- */
+
+  #ifndef BPM_INPUT_TYPE
+    #define BPM_INPUT_TYPE int
+  #endif
+
+  #ifndef BPM_INPUT
+    #define BPM_INPUT(S) bp_linux_read(S)
+  #endif
+
+  /* Timing --------------------------------------------------------------- */
+
+  #ifndef BPM_DELAY
+    #define BPM_DELAY delay
+  #endif
+
+  #ifndef BPM_DELAY_MICROSECONDS
+    #define BPM_DELAY_MICROSECONDS delayMicroseconds
+  #endif
+
+  #ifndef BPM_MICROS
+    #define BPM_MICROS micros
+  #endif
+
+  #ifndef BPM_MILLIS
+    #define BPM_MILLIS millis
+  #endif
+
+  /* Events (simulated pins and file descriptors watched with epoll) ----- */
+
+  #ifndef BPM_EVENT_PIN
+    #define BPM_EVENT_PIN bp_sim_event
+  #endif
+
+  #ifndef BPM_EVENT_SERIAL
+    #define BPM_EVENT_SERIAL(E, S) bp_epoll_watch(E, S)
+  #endif
+
+  #ifndef BPM_CHANNEL_WAIT
+    #define BPM_CHANNEL_WAIT() std::this_thread::yield()
+  #endif
+#endif
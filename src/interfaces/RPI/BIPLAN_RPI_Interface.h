@@ -22,8 +22,12 @@
   #include <inttypes.h>
   #include <stdlib.h>
   #include <string.h>
+  #include <unistd.h>
+  #include <sched.h>
   #include <wiringPi.h>
   #include <wiringSerial.h>
+  #include <wiringShift.h>
+  #include "../BIPLAN_Epoll_Events.h"
 
   /* Generic constants ---------------------------------------------------- */
 
@@ -64,14 +68,42 @@
     }
   #endif
 
-  /* Random ----------------------------------------------------------------- */
+  /* Port-wide IO, bit i of the mask is the state of pin + i ------------- */
+
+  void bp_rpi_write_mask(long pin, uint8_t n, uint32_t mask) {
+    if(!pin && (n == 8)) return digitalWriteByte(mask); // WiringPi pins 0-7
+    for(uint8_t i = 0; i < n; i++, mask >>= 1) digitalWrite(pin + i, mask & 1);
+  };
+
+  uint32_t bp_rpi_read_mask(long pin, uint8_t n) {
+    uint32_t mask = 0;
+    for(uint8_t i = 0; i < n; i++)
+      if(digitalRead(pin + i)) mask |= (uint32_t)1 << i;
+    return mask;
+  };
+
+  #if !defined(BPM_IO_WRITE_MASK)
+    #define BPM_IO_WRITE_MASK bp_rpi_write_mask
+  #endif
 
-  #ifndef BPM_RANDOM
-    #define BPM_RANDOM(randMax) (int)((1.0 + randMax) * rand() / ( RAND_MAX + 1.0 ) )
-    /* Scale rand()'s return value against RAND_MAX using doubles instead of
-       a pure modulus to have a more distributed result */
+  #if !defined(BPM_IO_READ_MASK)
+    #define BPM_IO_READ_MASK bp_rpi_read_mask
   #endif
 
+  #if !defined(BPM_IO_SHIFT_OUT)
+    #define BPM_IO_SHIFT_OUT(D, C, V) shiftOut(D, C, MSBFIRST, V)
+  #endif
+
+  /* Square root (floating point, see bp_fsqrt) ----------------------------- */
+
+  #ifndef BPM_SQRT
+    #define BPM_SQRT bp_fsqrt
+  #endif
+
+  /* Random ----------------------------------------------------------------- */
+
+  // Define BPM_RANDOM to replace the interpreter's xorshift32 generator
+
   #ifndef BPM_RANDOM_SEED
     #define BPM_RANDOM_SEED srand
   #endif
@@ -90,6 +122,11 @@
     #define BPM_SERIAL_WRITE(S, C) serialPutchar(S, C)
   #endif
 
+  #ifndef BPM_SERIAL_WRITE_BUF
+    #define BPM_SERIAL_WRITE_BUF(S, P, L) \
+      do { if(write(S, P, L)) { } } while(0)
+  #endif
+
   #ifndef BPM_SERIAL_READ
     #define BPM_SERIAL_READ(S) serialGetchar(S)
   #endif
@@ -115,4 +152,53 @@
   #ifndef BPM_MILLIS
     #define BPM_MILLIS millis
   #endif
+
+  /* Events ---------------------------------------------------------------
+     Pin changes are detected by the WiringPi interrupt threads, each of
+     the 4 trampolines below is bound to a pin the first time it is armed
+     (WiringPi cannot release them) and signals the event armed on it.
+     Serial data is detected with epoll (see BIPLAN_Epoll_Events.h). */
+
+  bp_event_t *volatile bp_rpi_events[4];
+  long bp_rpi_event_pins[4];
+  uint8_t bp_rpi_event_slots = 0;
+
+  template<uint8_t S> void bp_rpi_event_isr() {
+    bp_event_t *e = bp_rpi_events[S];
+    if(e) bp_event_signal(e);
+  };
+
+  void (*const bp_rpi_event_isrs[4])() = {
+    bp_rpi_event_isr<0>, bp_rpi_event_isr<1>,
+    bp_rpi_event_isr<2>, bp_rpi_event_isr<3>
+  };
+
+  bool bp_rpi_event_pin(bp_event_t *e, long pin) {
+    uint8_t slot = bp_rpi_event_slots;
+    for(uint8_t i = 0; i < bp_rpi_event_slots; i++)
+      if(bp_rpi_event_pins[i] == pin) slot = i;
+    if(slot == 4) return false;
+    if(slot == bp_rpi_event_slots) {
+      if(wiringPiISR(pin, INT_EDGE_BOTH, bp_rpi_event_isrs[slot]) < 0)
+        return false;
+      bp_rpi_event_pins[slot] = pin;
+      bp_rpi_event_slots++;
+    } // Armed, the slot of the previous pin (if moved) is released
+    for(uint8_t i = 0; i < bp_rpi_event_slots; i++)
+      if((i != slot) && (bp_rpi_events[i] == e)) bp_rpi_events[i] = NULL;
+    bp_rpi_events[slot] = e;
+    return true;
+  };
+
+  #ifndef BPM_EVENT_PIN
+    #define BPM_EVENT_PIN bp_rpi_event_pin
+  #endif
+
+  #ifndef BPM_EVENT_SERIAL
+    #define BPM_EVENT_SERIAL(E, S) bp_epoll_watch(E, S)
+  #endif
+
+  #ifndef BPM_CHANNEL_WAIT
+    #define BPM_CHANNEL_WAIT() sched_yield()
+  #endif
 #endif
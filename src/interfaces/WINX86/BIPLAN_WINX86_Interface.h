@@ -24,6 +24,7 @@
   #include <thread>
   #include <sstream>
   #include "Serial/Serial.h"
+  #include "../BIPLAN_Simulated_IO.h"
 
   #define OUTPUT 1
   #define INPUT 0
@@ -92,30 +93,46 @@
     #define BPM_AREAD(P) 0
   #endif
 
+  /* Digital IO operates on a simulated pin bank (BIPLAN_Simulated_IO.h) */
+
   #if !defined(BPM_IO_WRITE)
-    #define BPM_IO_WRITE(P, V)
+    #define BPM_IO_WRITE bp_sim_write
   #endif
 
   #if !defined(BPM_IO_READ)
-    #define BPM_IO_READ(P) 0
+    #define BPM_IO_READ bp_sim_read
   #endif
 
   #if !defined(BPM_IO_MODE)
-    #define BPM_IO_MODE(P, V)
+    #define BPM_IO_MODE bp_sim_mode
+  #endif
+
+  #if !defined(BPM_IO_WRITE_MASK)
+    #define BPM_IO_WRITE_MASK bp_sim_write_mask
+  #endif
+
+  #if !defined(BPM_IO_READ_MASK)
+    #define BPM_IO_READ_MASK bp_sim_read_mask
+  #endif
+
+  #if !defined(BPM_IO_SHIFT_OUT)
+    #define BPM_IO_SHIFT_OUT bp_sim_shift_out
   #endif
 
   #if !defined(BPM_IO_PULL_DOWN)
     #define BPM_IO_PULL_DOWN(P)
   #endif
 
-  /* Random ----------------------------------------------------------------- */
+  /* Square root (floating point, see bp_fsqrt) ----------------------------- */
 
-  #ifndef BPM_RANDOM
-    #define BPM_RANDOM(randMax) (int)((1.0 + randMax) * rand() / ( RAND_MAX + 1.0 ) )
-    /* Scale rand()'s return value against RAND_MAX using doubles instead of
-       a pure modulus to have a more distributed result */
+  #ifndef BPM_SQRT
+    #define BPM_SQRT bp_fsqrt
   #endif
 
+  /* Random ----------------------------------------------------------------- */
+
+  // Define BPM_RANDOM to replace the interpreter's xorshift32 generator
+
   #ifndef BPM_RANDOM_SEED
     #define BPM_RANDOM_SEED srand
   #endif
@@ -135,6 +152,10 @@
     #define BPM_SERIAL_WRITE(S, C) S->putChar((char*)&C)
   #endif
 
+  #ifndef BPM_SERIAL_WRITE_BUF
+    #define BPM_SERIAL_WRITE_BUF(S, P, L) S->write((char *)(P), L)
+  #endif
+
   #ifndef BPM_SERIAL_READ
     #define BPM_SERIAL_READ(S) S->getChar()
   #endif
@@ -161,4 +182,14 @@
   #ifndef BPM_MILLIS
     #define BPM_MILLIS millis
   #endif
+
+  /* Events, simulated pins signal changes, serial data is polled ------- */
+
+  #ifndef BPM_EVENT_PIN
+    #define BPM_EVENT_PIN bp_sim_event
+  #endif
+
+  #ifndef BPM_CHANNEL_WAIT
+    #define BPM_CHANNEL_WAIT() std::this_thread::yield()
+  #endif
 #endif
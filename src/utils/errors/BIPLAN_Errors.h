@@ -19,3 +19,17 @@
 #define BP_ERROR_BLOCK               "non matching condition delimiter"
 #define BP_ERROR_ROUND_PARENTHESIS   "non matching round parenthesis"
 #define BP_ERROR_MEM_SET             "memory update out of bound"
+#define BP_ERROR_MEM_GET             "memory access out of bound"
+#define BP_ERROR_MEM_VIEW            "invalid memory view width"
+#define BP_ERROR_STRING_GET          "string access out of bound"
+#define BP_ERROR_STRING_SET          "string update out of bound"
+#define BP_ERROR_STRING_ARENA        "string arena exhausted"
+#define BP_ERROR_FORMAT              "invalid printf format"
+#define BP_ERROR_JUMP                "jump out of program bound"
+#define BP_ERROR_IMAGE               "invalid program container"
+#define BP_ERROR_NATIVE              "native function not bound"
+#define BP_ERROR_NATIVE_CALL         "native function arguments mismatch"
+#define BP_ERROR_SYMBOLS             "symbol table full"
+#define BP_ERROR_CHANNEL             "channel not attached"
+#define BP_ERROR_EVENT               "no event handler available"
+#define BP_ERROR_TIMER               "no timer available"